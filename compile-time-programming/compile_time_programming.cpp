@@ -1,13 +1,27 @@
 #include "../helpers.hpp"
+#include "lookup_tables.hpp"
+#include "string_kernels.hpp"
 
 #include <algorithm>
 #include <array>
+#include <bit>
 #include <catch2/catch_test_macros.hpp>
+#include <cerrno>
+#include <chrono>
 #include <cstring>
+#include <iomanip>
 #include <iostream>
+#include <limits>
+#include <list>
 #include <map>
 #include <ranges>
+#include <set>
 #include <string>
+#include <string_view>
+#include <system_error>
+#include <tuple>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 using namespace std::literals;
@@ -80,7 +94,7 @@ constexpr int len(const char* s)
     }
     else
     {
-        return std::strlen(s); // function called at runtime
+        return StringKernels::length(s); // function called at runtime - SIMD
     }
 }
 
@@ -94,6 +108,155 @@ TEST_CASE("constexpr extensions")
     constexpr auto len_compile_time_text = len(compile_time_text);
 }
 
+namespace
+{
+    // pages followed by an inaccessible guard page - reading past end() crashes the test
+    // (without mmap: a plain buffer - the next page is readable)
+    class GuardedPages
+    {
+        static constexpr size_t page_size = 4096;
+
+        size_t no_of_pages_;
+        char* pages_;
+#if !HELPERS_HAS_MMAP
+        std::vector<char> buffer_;
+#endif
+
+    public:
+        explicit GuardedPages(size_t no_of_pages)
+            : no_of_pages_{no_of_pages}
+        {
+#if HELPERS_HAS_MMAP
+            void* memory = ::mmap(nullptr, (no_of_pages_ + 1) * page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (memory == MAP_FAILED)
+                throw std::system_error(errno, std::generic_category(), "mmap");
+            pages_ = static_cast<char*>(memory);
+
+            if (::mprotect(pages_ + no_of_pages_ * page_size, page_size, PROT_NONE) != 0)
+            {
+                const int error = errno;
+                ::munmap(pages_, (no_of_pages_ + 1) * page_size);
+                throw std::system_error(error, std::generic_category(), "mprotect");
+            }
+#else
+            buffer_.resize((no_of_pages_ + 2) * page_size);
+            pages_ = buffer_.data() + (page_size - reinterpret_cast<uintptr_t>(buffer_.data()) % page_size);
+#endif
+        }
+
+        GuardedPages(const GuardedPages&) = delete;
+        GuardedPages& operator=(const GuardedPages&) = delete;
+
+        ~GuardedPages()
+        {
+#if HELPERS_HAS_MMAP
+            ::munmap(pages_, (no_of_pages_ + 1) * page_size);
+#endif
+        }
+
+        char* end() const noexcept
+        {
+            return pages_ + no_of_pages_ * page_size;
+        }
+    };
+} // namespace
+
+TEST_CASE("string kernels")
+{
+    using namespace StringKernels;
+
+    SECTION("compile time")
+    {
+        static_assert(length("another text") == 12);
+        static_assert(length(""sv) == 0);
+        static_assert(*find("another text", 'x') == 'x' && find("another text", 'z') == nullptr);
+        static_assert(find("another text"sv, 't') == 3 && find("another text"sv, 'z') == std::string_view::npos);
+        static_assert(compare("abc", "abd") < 0 && compare("abc", "abc") == 0 && compare("abcd", "abc") > 0);
+        static_assert(compare("abc"sv, "abd"sv) < 0 && compare("ab"sv, "abc"sv) < 0 && compare("\xFF"sv, "a"sv) > 0);
+    }
+
+    SECTION("runtime - every offset & length against libc")
+    {
+        // strings ending right before a guard page - an over-read across the page boundary crashes,
+        // the page checks of compare are exercised
+        GuardedPages pages{2};
+        char* const page_end = pages.end();
+
+        for (size_t size = 0; size <= 300; ++size)
+        {
+            for (size_t offset : {0ul, 1ul, 7ul, 15ul, 31ul})
+            {
+                INFO("size: " << size << ", offset: " << offset);
+
+                char* s = page_end - size - 1 - offset;
+                std::fill(s, s + size, 'a');
+                s[size] = '\0';
+                if (size > 3)
+                    s[size - 2] = 'x';
+
+                std::string copy{s};
+                const std::string_view sv{s, size};
+
+                CHECK(length(s) == std::strlen(s));
+                CHECK(find(s, 'x') == std::strchr(s, 'x'));
+                CHECK(find(s, '\0') == std::strchr(s, '\0'));
+                CHECK(find(sv, 'x') == sv.find('x'));
+                CHECK(find(sv, 'y') == std::string_view::npos);
+
+                CHECK(compare(s, copy.c_str()) == 0);
+                CHECK(compare(sv, copy) == 0);
+                if (size > 0)
+                {
+                    ++copy[size / 2];
+                    CHECK(compare(s, copy.c_str()) < 0);
+                    CHECK(compare(copy.c_str(), s) > 0);
+                    CHECK(compare(sv, copy) < 0);
+                    CHECK(compare(copy, sv) > 0);
+                    CHECK(compare(sv.substr(0, size - 1), sv) < 0);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("string kernels vs. libc - short & long strings", "[.][benchmark]")
+{
+    using namespace StringKernels;
+
+    for (size_t size : {7ul, 15ul, 8192ul})
+    {
+        std::string text(size, 'a');
+        text.back() = 'x';
+        const std::string other = text.substr(0, size - 1) + 'y';
+
+        const size_t no_of_runs = 400'000'000 / (size + 16);
+
+        auto measure = [&](std::string_view name, auto kernel) {
+            const char* volatile opaque_text = text.c_str(); // the call cannot be hoisted out of the loop
+            const auto start = std::chrono::steady_clock::now();
+            size_t checksum = 0;
+            for (size_t run = 0; run < no_of_runs; ++run)
+                checksum += kernel(opaque_text);
+            const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+            std::cout << std::setw(5) << size << " B - " << std::setw(28) << std::left << name << std::right << ": " << std::setw(8)
+                      << std::fixed << std::setprecision(2) << elapsed.count() / no_of_runs << " ns (" << checksum / no_of_runs << ")\n"
+                      << std::defaultfloat;
+        };
+
+        measure("std::strlen", [](const char* s) { return std::strlen(s); });
+        measure("length", [](const char* s) { return length(s); });
+        measure("std::strchr", [](const char* s) { return static_cast<size_t>(std::strchr(s, 'x') - s); });
+        measure("find", [](const char* s) { return static_cast<size_t>(find(s, 'x') - s); });
+        measure("std::memchr", [&](const char* s) { return static_cast<size_t>(static_cast<const char*>(std::memchr(s, 'x', size)) - s); });
+        measure("find(string_view)", [&](const char* s) { return find(std::string_view{s, size}, 'x'); });
+        measure("std::strcmp", [&](const char* s) { return static_cast<size_t>(std::strcmp(s, other.c_str()) < 0); });
+        measure("compare", [&](const char* s) { return static_cast<size_t>(compare(s, other.c_str()) < 0); });
+        measure("std::memcmp", [&](const char* s) { return static_cast<size_t>(std::memcmp(s, other.data(), size) < 0); });
+        measure("compare(string_view)", [&](const char* s) { return static_cast<size_t>(compare(std::string_view{s, size}, other) < 0); });
+    }
+}
+
 //////////////////////////////////////////////////////////
 // constinit
 
@@ -131,26 +294,277 @@ TEST_CASE("constexpr functions")
     Helpers::print(numbers, "numbers");
 }
 
+TEST_CASE("lookup tables")
+{
+    using namespace LookupTables;
+
+    SECTION("make_table generalizes create_powers")
+    {
+        constexpr auto squares = make_table<20>([](size_t i) { return static_cast<uint32_t>((i + 1) * (i + 1)); });
+        static_assert(squares == create_powers<20>());
+
+        CHECK(table<100, square>()[99] == 99 * 99);
+    }
+
+    SECTION("table-driven functions - the same results at compile time & at runtime")
+    {
+        static_assert(crc32("123456789") == 0xCBF43926);
+        static_assert(popcount(0xF0F0'0001) == 9);
+        static_assert(floor_log2(1'000'000) == 19);
+        static_assert(is_power_of_2(1024) && !is_power_of_2(1023));
+
+        std::string text = "123456789";
+        CHECK(crc32(text) == 0xCBF43926);
+        CHECK(crc32("") == 0);
+
+        for (uint32_t value : {0u, 1u, 2u, 3u, 255u, 256u, 65535u, 65536u, 1'000'000u, 0x8000'0000u, 0xFFFF'FFFFu})
+        {
+            CHECK(popcount(value) == std::popcount(value));
+            if (value)
+                CHECK(floor_log2(value) == static_cast<int>(std::bit_width(value)) - 1);
+        }
+
+        CHECK(std::ranges::all_of(std::views::iota(0u, 0x10000u), [](uint32_t value) {
+            return is_power_of_2(static_cast<uint16_t>(value)) == std::has_single_bit(value);
+        }));
+    }
+
+    SECTION("tables above compile_time_limit are built at runtime")
+    {
+        const auto squares = table<compile_time_limit + 1, square>();
+        static_assert(squares.size() == compile_time_limit + 1);
+
+        CHECK(squares[compile_time_limit] == compile_time_limit * compile_time_limit);
+        CHECK(squares.data() == table<compile_time_limit + 1, square>().data()); // built once
+    }
+}
+
+TEST_CASE("lookup tables - startup & per call", "[.][benchmark]")
+{
+    using namespace LookupTables;
+
+    auto measure = [](std::string_view name, size_t no_of_calls, auto action) {
+        const auto start = std::chrono::steady_clock::now();
+        const uint64_t checksum = action();
+        const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::cout << std::setw(36) << std::left << name << std::right << ": " << std::setw(10) << std::fixed << std::setprecision(3)
+                  << elapsed.count() / no_of_calls << " ns/call (" << checksum << ")\n" << std::defaultfloat;
+    };
+
+    std::cout << "Startup:\n";
+    measure("64K entries - constinit (no work)", 1, [] { return table<0x10000, bit_count>()[0xFFFF]; });
+    measure("64K entries - built at runtime", 1, [] {
+        volatile size_t size = 0x10000; // not foldable by the optimizer
+        std::vector<uint8_t> counts(size);
+        for (size_t i = 0; i < counts.size(); ++i)
+            counts[i] = bit_count(i);
+        return counts.back();
+    });
+    measure("16M entries - built at first use", 1, [] { return table<(1 << 24), bit_count>()[(1 << 24) - 1]; });
+
+    constexpr size_t size = 64 * 1024 * 1024;
+    const std::vector<int> numbers = Helpers::create_numeric_dataset(size / 4, std::numeric_limits<int>::min(), std::numeric_limits<int>::max(), Helpers::DatasetOptions{});
+    const std::string_view bytes{reinterpret_cast<const char*>(numbers.data()), size};
+
+    std::cout << "Per call:\n";
+    measure("crc32 - bitwise (per byte)", size, [&] {
+        uint32_t crc = 0xFFFFFFFFu;
+        for (unsigned char byte : bytes)
+            crc = (crc >> 8) ^ crc32_of_byte((crc ^ byte) & 0xFF);
+        return ~crc;
+    });
+    measure("crc32 - table (per byte)", size, [&] { return crc32(bytes); });
+
+    auto for_all_numbers = [&](auto f) {
+        uint64_t checksum = 0;
+        for (int number : numbers)
+            checksum += f(static_cast<uint32_t>(number));
+        return checksum;
+    };
+
+    measure("popcount - bit loop", numbers.size(), [&] { return for_all_numbers(bit_count); });
+    measure("popcount - table", numbers.size(), [&] { return for_all_numbers([](uint32_t x) { return popcount(x); }); });
+    measure("popcount - std::popcount", numbers.size(), [&] { return for_all_numbers([](uint32_t x) { return std::popcount(x); }); });
+    measure("floor_log2 - shift loop", numbers.size(), [&] { return for_all_numbers(floor_log2_of); });
+    measure("floor_log2 - table", numbers.size(), [&] { return for_all_numbers([](uint32_t x) { return floor_log2(x); }); });
+    measure("floor_log2 - std::bit_width", numbers.size(), [&] { return for_all_numbers([](uint32_t x) { return std::bit_width(x) - 1; }); });
+}
+
+namespace UniqueAvg
+{
+    ///////////////////////////////////////////////////////////
+    // Average of unique items of many ranges - three strategies
+    //  - all inputs sorted: streaming k-way merge - the heads of the ranges are compared by
+    //    a fold expression (k is known at compile time) & duplicates are skipped in place - no copies
+    //  - large unsorted inputs (runtime only): sum of the items newly inserted into a hash set
+    //  - otherwise: copy, sort & unique
+
+    inline constexpr size_t hash_set_threshold = 64 * 1024;
+
+    // integral items are summed in a widened type - a sum of many unique ints overflows int
+    template <typename TElement>
+    using SumType = std::conditional_t<std::integral<TElement>,
+        std::conditional_t<std::is_signed_v<TElement>, long long, unsigned long long>, TElement>;
+
+    template <typename T>
+    concept Hashable = requires(const T& item) {
+        { std::hash<T>{}(item) } -> std::convertible_to<size_t>;
+    };
+
+    // heads of the ranges are referenced while merging
+    template <typename TRng, typename TElement>
+    concept MergeableRange = std::ranges::forward_range<TRng>
+        && std::same_as<std::ranges::range_reference_t<const TRng>, const TElement&>;
+
+    template <typename TElement, std::ranges::input_range... TRng_>
+    constexpr double avg_for_unique_sorted_copy(const TRng_&... rng)
+    {
+        std::vector<TElement> vec;                            // empty vector
+        vec.reserve((rng.size() + ...));                      // reserve a buffer
+        (vec.insert(vec.end(), rng.begin(), rng.end()), ...); // fold expression C++17
+
+        // sort items
+        std::ranges::sort(vec); // std::sort(vec.begin(), vec.end());
+
+        // create span of unique_items
+        auto new_end = std::unique(vec.begin(), vec.end());
+        std::span unique_items{vec.begin(), new_end};
+
+        // calculate sum of unique items
+        auto sum = std::accumulate(unique_items.begin(), unique_items.end(), SumType<TElement>{});
+
+        return sum / static_cast<double>(unique_items.size());
+    }
+
+    template <typename TElement, MergeableRange<TElement>... TRng_>
+    constexpr double avg_for_unique_merged(const TRng_&... rng)
+    {
+        std::tuple heads{std::ranges::subrange(rng)...};
+
+        SumType<TElement> sum{};
+        size_t count = 0;
+
+        while (true)
+        {
+            const TElement* min = nullptr;
+            auto find_min = [&](const auto& head) {
+                if (!head.empty() && (!min || *head.begin() < *min))
+                    min = &*head.begin();
+            };
+            std::apply([&](const auto&... head) { (find_min(head), ...); }, heads);
+
+            if (!min)
+                break;
+
+            const TElement value = *min;
+            sum += value;
+            ++count;
+
+            // the value (and its duplicates) can only be at the front of each range
+            auto skip_value = [&](auto& head) {
+                head = {std::ranges::find_if(head, [&](const TElement& item) { return value < item; }), head.end()};
+            };
+            std::apply([&](auto&... head) { (skip_value(head), ...); }, heads);
+        }
+
+        return sum / static_cast<double>(count);
+    }
+
+    // open addressing with linear probing - no allocation per item, unlike std::unordered_set
+    template <std::integral T>
+    class FlatIntegralSet
+    {
+    public:
+        // .second - like std::unordered_set - is true if the item was inserted
+        std::pair<T, bool> insert(T item)
+        {
+            if (2 * (size_ + 1) > slots_.size())
+                rehash(std::max<size_t>(16, 2 * slots_.size()));
+
+            return {item, insert_unchecked(item)};
+        }
+
+        size_t size() const noexcept
+        {
+            return size_;
+        }
+
+    private:
+        std::vector<T> slots_;
+        std::vector<bool> occupied_;
+        size_t size_ = 0;
+
+        size_t index_of(T item) const noexcept
+        {
+            constexpr uint64_t golden_ratio = 0x9E3779B97F4A7C15;
+            return static_cast<size_t>((static_cast<uint64_t>(item) * golden_ratio) >> 32) & (slots_.size() - 1);
+        }
+
+        bool insert_unchecked(T item)
+        {
+            for (size_t i = index_of(item);; i = (i + 1) & (slots_.size() - 1))
+            {
+                if (!occupied_[i])
+                {
+                    slots_[i] = item;
+                    occupied_[i] = true;
+                    ++size_;
+                    return true;
+                }
+
+                if (slots_[i] == item)
+                    return false;
+            }
+        }
+
+        void rehash(size_t capacity)
+        {
+            std::vector<T> old_slots = std::exchange(slots_, std::vector<T>(capacity));
+            std::vector<bool> old_occupied = std::exchange(occupied_, std::vector<bool>(capacity));
+            size_ = 0;
+
+            for (size_t i = 0; i < old_slots.size(); ++i)
+                if (old_occupied[i])
+                    insert_unchecked(old_slots[i]);
+        }
+    };
+
+    template <Hashable TElement, std::ranges::input_range... TRng_>
+    double avg_for_unique_hashed(const TRng_&... rng)
+    {
+        std::conditional_t<std::integral<TElement>, FlatIntegralSet<TElement>, std::unordered_set<TElement>> unique_items;
+        SumType<TElement> sum{};
+
+        auto add = [&](const auto& items) {
+            for (const auto& item : items)
+                if (unique_items.insert(item).second)
+                    sum += item;
+        };
+        (add(rng), ...);
+
+        return sum / static_cast<double>(unique_items.size());
+    }
+} // namespace UniqueAvg
+
 template <std::ranges::input_range... TRng_>
 constexpr auto avg_for_unique(const TRng_&... rng)
 {
     using TElement = std::common_type_t<std::ranges::range_value_t<TRng_>...>;
 
-    std::vector<TElement> vec;                            // empty vector
-    vec.reserve((rng.size() + ...));                      // reserve a buffer
-    (vec.insert(vec.end(), rng.begin(), rng.end()), ...); // fold expression C++17
-
-    // sort items
-    std::ranges::sort(vec); // std::sort(vec.begin(), vec.end());
-
-    // create span of unique_items
-    auto new_end = std::unique(vec.begin(), vec.end());
-    std::span unique_items{vec.begin(), new_end};
+    if constexpr ((UniqueAvg::MergeableRange<TRng_, TElement> && ...))
+    {
+        if ((std::ranges::is_sorted(rng) && ...))
+            return UniqueAvg::avg_for_unique_merged<TElement>(rng...);
+    }
 
-    // calculate sum of unique items
-    auto sum = std::accumulate(unique_items.begin(), unique_items.end(), TElement{});
+    if constexpr (UniqueAvg::Hashable<TElement>)
+    {
+        if (!std::is_constant_evaluated() && (std::ranges::size(rng) + ...) >= UniqueAvg::hash_set_threshold)
+            return UniqueAvg::avg_for_unique_hashed<TElement>(rng...);
+    }
 
-    return sum / static_cast<double>(unique_items.size());
+    return UniqueAvg::avg_for_unique_sorted_copy<TElement>(rng...);
 }
 
 TEST_CASE("avg for unique")
@@ -161,4 +575,73 @@ TEST_CASE("avg for unique")
     constexpr auto avg = avg_for_unique(lst1, lst2);
 
     std::cout << "AVG: " << avg << "\n";
-}
\ No newline at end of file
+
+    SECTION("constexpr - merge & sort paths")
+    {
+        static_assert(avg == 5.0);                                                       // merge
+        static_assert(avg_for_unique(std::array{5, 1, 3}, std::array{3, 9, 1}) == 4.5); // sort
+        static_assert(UniqueAvg::avg_for_unique_merged<int>(std::array{1, 1, 2}, std::array<int, 0>{}, std::array{2, 3}) == 2.0);
+    }
+
+    SECTION("all strategies give the same result")
+    {
+        const std::vector<int> unsorted1 = Helpers::create_numeric_dataset(100'000, 0, 50'000, Helpers::DatasetOptions{.seed = 1});
+        const std::vector<int> unsorted2 = Helpers::create_numeric_dataset(100'000, 25'000, 75'000, Helpers::DatasetOptions{.seed = 2});
+        std::vector<int> sorted1 = unsorted1;
+        std::vector<int> sorted2 = unsorted2;
+        std::ranges::sort(sorted1);
+        std::ranges::sort(sorted2);
+
+        // 67,810 unique values - their sum (~2.5e9) doesn't fit in int
+        std::set<int> unique_items(unsorted1.begin(), unsorted1.end());
+        unique_items.insert(unsorted2.begin(), unsorted2.end());
+        const long long reference_sum = std::accumulate(unique_items.begin(), unique_items.end(), 0LL);
+        REQUIRE(reference_sum > std::numeric_limits<int>::max());
+
+        const double expected = UniqueAvg::avg_for_unique_sorted_copy<int>(unsorted1, unsorted2);
+        CHECK(expected == reference_sum / static_cast<double>(unique_items.size()));
+
+        CHECK(avg_for_unique(sorted1, sorted2) == expected);
+        CHECK(UniqueAvg::avg_for_unique_merged<int>(sorted1, sorted2) == expected);
+        CHECK(avg_for_unique(unsorted1, unsorted2) == expected);
+        CHECK(UniqueAvg::avg_for_unique_hashed<int>(unsorted1, unsorted2) == expected);
+    }
+
+    SECTION("different value types - common type")
+    {
+        const std::list<int> lst = {3, 3, 4};
+        const std::vector<long> vec = {4, 5};
+        CHECK(avg_for_unique(lst, vec) == 4.0);
+    }
+}
+
+TEST_CASE("avg for unique - 8 x 10M items", "[.][benchmark]")
+{
+    constexpr size_t size = 10'000'000;
+
+    // ~20M unique values - their sum overflows int, UniqueAvg::SumType is long long
+    std::vector<std::vector<int>> inputs;
+    for (uint64_t seed = 0; seed < 8; ++seed)
+        inputs.push_back(Helpers::create_numeric_dataset(size, 0, 20'000'000, Helpers::DatasetOptions{.seed = seed}));
+
+    auto measure = [&](std::string_view name, auto average) {
+        const auto start = std::chrono::steady_clock::now();
+        const double result = [&]<size_t... I>(std::index_sequence<I...>) { return average(inputs[I]...); }(std::make_index_sequence<8>{});
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::cout << std::setw(30) << std::left << name << std::right << ": " << std::setw(8) << std::fixed << std::setprecision(1)
+                  << elapsed.count() * 1000 << " ms (avg " << result << ")\n" << std::defaultfloat;
+    };
+
+    auto copy_sort_unique = [](const auto&... rng) { return UniqueAvg::avg_for_unique_sorted_copy<int>(rng...); };
+    auto dispatched = [](const auto&... rng) { return avg_for_unique(rng...); };
+
+    measure("unsorted - copy, sort & unique", copy_sort_unique);
+    measure("unsorted - hash set", dispatched);
+
+    for (auto& input : inputs)
+        std::ranges::sort(input);
+
+    measure("sorted - copy, sort & unique", copy_sort_unique);
+    measure("sorted - k-way merge", dispatched);
+}
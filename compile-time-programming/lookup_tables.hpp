@@ -0,0 +1,151 @@
+#ifndef LOOKUP_TABLES_HPP
+#define LOOKUP_TABLES_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+namespace LookupTables
+{
+    ///////////////////////////////////////////////////////////////////////
+    // Precomputed tables
+    //  - make_table<N>(f) - std::array of f(0), f(1), ..., f(N-1) - usable at compile time
+    //  - table<N, f>() - span over the table of a generator:
+    //      * up to compile_time_limit entries - a constinit const array: built by the compiler,
+    //        placed in .rodata, nothing is computed at startup
+    //      * larger tables would hit the compiler's constexpr limits (gcc: -fconstexpr-loop-limit=262144)
+    //        and bloat the binary - they are built at runtime on first use (thread-safe)
+    //  - generators are captureless lambdas passed as template arguments - the same generator object
+    //    gives the same table in every translation unit
+
+    inline constexpr size_t compile_time_limit = 64 * 1024;
+
+    template <size_t N, typename TGenerator>
+    constexpr auto make_table(TGenerator generator)
+    {
+        std::array<std::invoke_result_t<TGenerator&, size_t>, N> table{};
+        for (size_t i = 0; i < N; ++i)
+            table[i] = generator(i);
+        return table;
+    }
+
+    namespace Detail
+    {
+        template <size_t N, auto Generator>
+        inline constinit const auto compile_time_table = make_table<N>(Generator);
+
+        template <size_t N, auto Generator>
+        const auto& runtime_table()
+        {
+            using Table = decltype(make_table<N>(Generator));
+
+            static const std::unique_ptr<const Table> table = [] {
+                auto table = std::make_unique<Table>();
+                for (size_t i = 0; i < N; ++i)
+                    (*table)[i] = Generator(i);
+                return table;
+            }();
+
+            return *table;
+        }
+    } // namespace Detail
+
+    template <size_t N, auto Generator>
+    auto table()
+    {
+        using T = std::invoke_result_t<decltype(Generator)&, size_t>;
+
+        if constexpr (N <= compile_time_limit)
+            return std::span<const T, N>{Detail::compile_time_table<N, Generator>};
+        else
+            return std::span<const T, N>{Detail::runtime_table<N, Generator>()};
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    // Generators
+
+    inline constexpr auto square = [](size_t i) -> uint64_t { return i * i; };
+
+    // CRC-32 (IEEE 802.3, reflected) of a single byte
+    inline constexpr auto crc32_of_byte = [](size_t byte) -> uint32_t {
+        uint32_t crc = static_cast<uint32_t>(byte);
+        for (int bit = 0; bit < 8; ++bit)
+            crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+        return crc;
+    };
+
+    inline constexpr auto bit_count = [](size_t value) -> uint8_t {
+        uint8_t count = 0;
+        for (; value; value &= value - 1)
+            ++count;
+        return count;
+    };
+
+    // floor(log2(value)); 0 for value == 0
+    inline constexpr auto floor_log2_of = [](size_t value) -> uint8_t {
+        uint8_t result = 0;
+        while (value >>= 1)
+            ++result;
+        return result;
+    };
+
+    inline constexpr auto is_power_of_2_answer = [](size_t value) -> bool {
+        return value != 0 && (value & (value - 1)) == 0;
+    };
+
+    ///////////////////////////////////////////////////////////////////////
+    // Table-driven functions - at compile time the tables are not readable (not constexpr),
+    // so the generators are called directly
+
+    constexpr uint32_t crc32(std::string_view data)
+    {
+        uint32_t crc = 0xFFFFFFFFu;
+
+        if (std::is_constant_evaluated())
+        {
+            for (unsigned char byte : data)
+                crc = (crc >> 8) ^ crc32_of_byte((crc ^ byte) & 0xFF);
+        }
+        else
+        {
+            const auto crc_table = table<256, crc32_of_byte>();
+            for (unsigned char byte : data)
+                crc = (crc >> 8) ^ crc_table[(crc ^ byte) & 0xFF];
+        }
+
+        return ~crc;
+    }
+
+    constexpr int popcount(uint32_t value)
+    {
+        if (std::is_constant_evaluated())
+            return bit_count(value);
+
+        const auto counts = table<0x10000, bit_count>();
+        return counts[value & 0xFFFF] + counts[value >> 16];
+    }
+
+    constexpr int floor_log2(uint32_t value)
+    {
+        if (std::is_constant_evaluated())
+            return floor_log2_of(value);
+
+        const auto logs = table<0x10000, floor_log2_of>();
+        return (value >> 16) ? 16 + logs[value >> 16] : logs[value];
+    }
+
+    constexpr bool is_power_of_2(uint16_t value)
+    {
+        if (std::is_constant_evaluated())
+            return is_power_of_2_answer(value);
+
+        return table<0x10000, is_power_of_2_answer>()[value];
+    }
+} // namespace LookupTables
+
+#endif // LOOKUP_TABLES_HPP
@@ -0,0 +1,376 @@
+#ifndef STRING_KERNELS_HPP
+#define STRING_KERNELS_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#define STRING_KERNELS_X86 1
+#else
+#define STRING_KERNELS_X86 0
+#endif
+
+// reading past the terminator (within a page) is reported by AddressSanitizer & ThreadSanitizer
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+#define STRING_KERNELS_ALLOW_OVERREAD 0
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer) || __has_feature(thread_sanitizer)
+#define STRING_KERNELS_ALLOW_OVERREAD 0
+#endif
+#endif
+#ifndef STRING_KERNELS_ALLOW_OVERREAD
+#define STRING_KERNELS_ALLOW_OVERREAD 1
+#endif
+
+namespace StringKernels
+{
+    ///////////////////////////////////////////////////////////////////////
+    // Dual-mode string kernels: length, find (char) & compare
+    //  - at compile time: plain character loops
+    //  - at runtime: SSE2/AVX2 blocks of 16/32 bytes, groups of 4 blocks for long strings
+    //      * null-terminated strings - aligned loads never cross a page boundary, so reading up to
+    //        the end of the block (group) containing the terminator is safe; compare checks the page
+    //        offsets of both strings, as they are aligned differently
+    //      * std::string_view - the size is known: whole blocks & one overlapping last block;
+    //        strings shorter than a block are read with one load if it stays within the page
+    //  - without SIMD (or under AddressSanitizer for null-terminated strings) the libc functions are used
+
+    namespace Detail
+    {
+#if STRING_KERNELS_X86
+#if defined(__AVX2__)
+        using Block = __m256i;
+
+        inline Block load(const char* p) noexcept { return _mm256_load_si256(reinterpret_cast<const Block*>(p)); }
+        inline Block loadu(const char* p) noexcept { return _mm256_loadu_si256(reinterpret_cast<const Block*>(p)); }
+        inline Block splat(char c) noexcept { return _mm256_set1_epi8(c); }
+        inline Block equal(Block a, Block b) noexcept { return _mm256_cmpeq_epi8(a, b); }
+        inline Block bit_or(Block a, Block b) noexcept { return _mm256_or_si256(a, b); }
+        inline Block bit_xor(Block a, Block b) noexcept { return _mm256_xor_si256(a, b); }
+        inline Block bit_and(Block a, Block b) noexcept { return _mm256_and_si256(a, b); }
+        inline Block min_bytes(Block a, Block b) noexcept { return _mm256_min_epu8(a, b); }
+        inline uint32_t byte_mask(Block b) noexcept { return static_cast<uint32_t>(_mm256_movemask_epi8(b)); }
+#else
+        using Block = __m128i;
+
+        inline Block load(const char* p) noexcept { return _mm_load_si128(reinterpret_cast<const Block*>(p)); }
+        inline Block loadu(const char* p) noexcept { return _mm_loadu_si128(reinterpret_cast<const Block*>(p)); }
+        inline Block splat(char c) noexcept { return _mm_set1_epi8(c); }
+        inline Block equal(Block a, Block b) noexcept { return _mm_cmpeq_epi8(a, b); }
+        inline Block bit_or(Block a, Block b) noexcept { return _mm_or_si128(a, b); }
+        inline Block bit_xor(Block a, Block b) noexcept { return _mm_xor_si128(a, b); }
+        inline Block bit_and(Block a, Block b) noexcept { return _mm_and_si128(a, b); }
+        inline Block min_bytes(Block a, Block b) noexcept { return _mm_min_epu8(a, b); }
+        inline uint32_t byte_mask(Block b) noexcept { return static_cast<uint32_t>(_mm_movemask_epi8(b)); }
+#endif
+        inline constexpr size_t block_size = sizeof(Block);
+        inline constexpr size_t group_size = 4 * block_size;
+        inline constexpr uint32_t all_bytes = (block_size == 32) ? 0xFFFF'FFFFu : 0xFFFFu;
+        inline constexpr size_t page_size = 4096;
+
+        inline bool fits_in_page(const char* p, size_t size) noexcept
+        {
+            return (reinterpret_cast<uintptr_t>(p) & (page_size - 1)) <= page_size - size;
+        }
+
+        // mask of the first n (< 32) bytes of a block
+        inline uint32_t first_bytes(size_t n) noexcept
+        {
+            return (1u << n) - 1;
+        }
+
+        // offset of the first set bit of a group of 4 block masks (one of them is not 0)
+        inline size_t first_in_group(uint32_t mask0, uint32_t mask1, uint32_t mask2, uint32_t mask3) noexcept
+        {
+            if (mask0)
+                return std::countr_zero(mask0);
+            if (mask1)
+                return block_size + std::countr_zero(mask1);
+            if (mask2)
+                return 2 * block_size + std::countr_zero(mask2);
+            return 3 * block_size + std::countr_zero(mask3);
+        }
+
+        // mask of the zero bytes of a block
+        inline uint32_t zero_mask(Block b) noexcept
+        {
+            return byte_mask(equal(b, splat('\0')));
+        }
+
+        // a group of 4 blocks has a zero byte if their bytewise minimum has one (fewer ops than 4 compares)
+        inline Block group_min(Block b0, Block b1, Block b2, Block b3) noexcept
+        {
+            return min_bytes(min_bytes(b0, b1), min_bytes(b2, b3));
+        }
+
+        // first byte at or after s for which hits (Block -> Block) gives 0x00 - whole aligned blocks,
+        // then aligned groups of 4 blocks
+        template <typename THits>
+        inline const char* first_hit(const char* s, THits hits) noexcept
+        {
+            const char* block = reinterpret_cast<const char*>(reinterpret_cast<uintptr_t>(s) & ~(block_size - 1));
+            if (const uint32_t mask = zero_mask(hits(load(block))) >> (s - block))
+                return s + std::countr_zero(mask);
+
+            for (block += block_size; reinterpret_cast<uintptr_t>(block) % group_size != 0; block += block_size)
+                if (const uint32_t mask = zero_mask(hits(load(block))))
+                    return block + std::countr_zero(mask);
+
+            for (;; block += group_size)
+            {
+                const Block h0 = hits(load(block)), h1 = hits(load(block + block_size)),
+                            h2 = hits(load(block + 2 * block_size)), h3 = hits(load(block + 3 * block_size));
+
+                if (zero_mask(group_min(h0, h1, h2, h3)))
+                    return block + first_in_group(zero_mask(h0), zero_mask(h1), zero_mask(h2), zero_mask(h3));
+            }
+        }
+
+        // 0x00 where the strings differ (equal gives 0x00) or a ends
+        inline Block stop_bytes(Block a, Block b) noexcept
+        {
+            return min_bytes(a, equal(a, b));
+        }
+#endif
+
+        constexpr int compare_chars(char a, char b) noexcept
+        {
+            return static_cast<int>(static_cast<unsigned char>(a)) - static_cast<int>(static_cast<unsigned char>(b));
+        }
+    } // namespace Detail
+
+    constexpr size_t length(const char* s)
+    {
+        if (std::is_constant_evaluated())
+        {
+            size_t idx = 0;
+            while (s[idx] != '\0')
+                ++idx;
+            return idx;
+        }
+
+#if STRING_KERNELS_X86 && STRING_KERNELS_ALLOW_OVERREAD
+        return static_cast<size_t>(Detail::first_hit(s, [](Detail::Block b) { return b; }) - s);
+#else
+        return std::strlen(s);
+#endif
+    }
+
+    constexpr size_t length(std::string_view s) noexcept
+    {
+        return s.size();
+    }
+
+    // like strchr: pointer to the first c in s or nullptr (c == '\0' finds the terminator)
+    constexpr const char* find(const char* s, char c)
+    {
+        if (std::is_constant_evaluated())
+        {
+            for (;; ++s)
+            {
+                if (*s == c)
+                    return s;
+                if (*s == '\0')
+                    return nullptr;
+            }
+        }
+
+#if STRING_KERNELS_X86 && STRING_KERNELS_ALLOW_OVERREAD
+        // b ^ c is 0x00 for c - min(b, b ^ c) is 0x00 for c or the terminator
+        const Detail::Block wanted = Detail::splat(c);
+        const char* match = Detail::first_hit(s, [&](Detail::Block b) { return Detail::min_bytes(b, Detail::bit_xor(b, wanted)); });
+        return (*match == c) ? match : nullptr;
+#else
+        return std::strchr(s, c);
+#endif
+    }
+
+    // index of the first c in s or std::string_view::npos
+    constexpr size_t find(std::string_view s, char c)
+    {
+        size_t i = 0;
+
+        if (!std::is_constant_evaluated())
+        {
+#if STRING_KERNELS_X86
+            using namespace Detail;
+
+            const char* const data = s.data();
+            const Block wanted = splat(c);
+            auto matches_at = [&](size_t pos) { return equal(loadu(data + pos), wanted); };
+
+            if (s.size() >= block_size)
+            {
+                for (; i + group_size <= s.size(); i += group_size)
+                {
+                    const Block m0 = matches_at(i), m1 = matches_at(i + block_size), m2 = matches_at(i + 2 * block_size), m3 = matches_at(i + 3 * block_size);
+
+                    if (byte_mask(bit_or(bit_or(m0, m1), bit_or(m2, m3))))
+                        return i + first_in_group(byte_mask(m0), byte_mask(m1), byte_mask(m2), byte_mask(m3));
+                }
+
+                for (; i + block_size <= s.size(); i += block_size)
+                    if (const uint32_t mask = byte_mask(matches_at(i)))
+                        return i + std::countr_zero(mask);
+
+                if (i < s.size()) // the last block overlaps the previous one
+                {
+                    const size_t last = s.size() - block_size;
+                    if (const uint32_t mask = byte_mask(matches_at(last)) >> (i - last))
+                        return i + std::countr_zero(mask);
+                }
+
+                return std::string_view::npos;
+            }
+#if STRING_KERNELS_ALLOW_OVERREAD
+            else if (!s.empty() && fits_in_page(data, block_size))
+            {
+                const uint32_t mask = byte_mask(matches_at(0)) & first_bytes(s.size());
+                return mask ? std::countr_zero(mask) : std::string_view::npos;
+            }
+#endif
+#endif
+        }
+
+        for (; i < s.size(); ++i)
+            if (s[i] == c)
+                return i;
+
+        return std::string_view::npos;
+    }
+
+    // like strcmp: < 0, 0 or > 0 (bytes compared as unsigned char)
+    constexpr int compare(const char* a, const char* b)
+    {
+        if (!std::is_constant_evaluated())
+        {
+#if STRING_KERNELS_X86 && STRING_KERNELS_ALLOW_OVERREAD
+            using namespace Detail;
+
+            auto stop_at = [&](size_t pos) { return stop_bytes(loadu(a + pos), loadu(b + pos)); };
+            auto result_at = [&](size_t pos) { return compare_chars(a[pos], b[pos]); };
+
+            // short strings usually end in the first block
+            if (fits_in_page(a, block_size) && fits_in_page(b, block_size))
+            {
+                if (const uint32_t mask = zero_mask(stop_at(0)))
+                    return result_at(std::countr_zero(mask));
+                a += block_size;
+                b += block_size;
+            }
+
+            while (true)
+            {
+                if (fits_in_page(a, group_size) && fits_in_page(b, group_size))
+                {
+                    const Block s0 = stop_at(0), s1 = stop_at(block_size), s2 = stop_at(2 * block_size), s3 = stop_at(3 * block_size);
+
+                    if (zero_mask(group_min(s0, s1, s2, s3)))
+                        return result_at(first_in_group(zero_mask(s0), zero_mask(s1), zero_mask(s2), zero_mask(s3)));
+
+                    a += group_size;
+                    b += group_size;
+                }
+                else if (fits_in_page(a, block_size) && fits_in_page(b, block_size))
+                {
+                    if (const uint32_t mask = zero_mask(stop_at(0)))
+                        return result_at(std::countr_zero(mask));
+                    a += block_size;
+                    b += block_size;
+                }
+                else // a block would cross a page boundary - byte by byte up to it
+                {
+                    const size_t to_page_end = std::min(page_size - (reinterpret_cast<uintptr_t>(a) & (page_size - 1)),
+                                                        page_size - (reinterpret_cast<uintptr_t>(b) & (page_size - 1)));
+                    for (size_t i = 0; i < to_page_end; ++i, ++a, ++b)
+                        if (*a != *b || *a == '\0')
+                            return compare_chars(*a, *b);
+                }
+            }
+#else
+            return std::strcmp(a, b);
+#endif
+        }
+
+        for (; *a == *b && *a != '\0'; ++a, ++b)
+            ;
+        return Detail::compare_chars(*a, *b);
+    }
+
+    // like std::string_view::compare: < 0, 0 or > 0
+    constexpr int compare(std::string_view a, std::string_view b)
+    {
+        const size_t common_size = std::min(a.size(), b.size());
+        size_t i = 0;
+
+        if (!std::is_constant_evaluated())
+        {
+#if STRING_KERNELS_X86
+            using namespace Detail;
+
+            auto equal_at = [&](size_t pos) { return equal(loadu(a.data() + pos), loadu(b.data() + pos)); };
+            auto differ_at = [&](size_t pos) { return ~byte_mask(equal_at(pos)) & all_bytes; };
+
+            if (common_size >= block_size)
+            {
+                for (; i + group_size <= common_size; i += group_size)
+                {
+                    const Block e0 = equal_at(i), e1 = equal_at(i + block_size), e2 = equal_at(i + 2 * block_size), e3 = equal_at(i + 3 * block_size);
+
+                    if (byte_mask(bit_and(bit_and(e0, e1), bit_and(e2, e3))) != all_bytes)
+                    {
+                        auto differ = [](Block e) { return ~byte_mask(e) & all_bytes; };
+                        const size_t j = i + first_in_group(differ(e0), differ(e1), differ(e2), differ(e3));
+                        return compare_chars(a[j], b[j]);
+                    }
+                }
+
+                for (; i + block_size <= common_size; i += block_size)
+                    if (const uint32_t mask = differ_at(i))
+                    {
+                        const size_t j = i + std::countr_zero(mask);
+                        return compare_chars(a[j], b[j]);
+                    }
+
+                if (i < common_size) // the last block overlaps the previous one
+                {
+                    const size_t last = common_size - block_size;
+                    if (const uint32_t mask = differ_at(last) >> (i - last))
+                    {
+                        const size_t j = i + std::countr_zero(mask);
+                        return compare_chars(a[j], b[j]);
+                    }
+                }
+
+                i = common_size;
+            }
+#if STRING_KERNELS_ALLOW_OVERREAD
+            else if (common_size > 0 && fits_in_page(a.data(), block_size) && fits_in_page(b.data(), block_size))
+            {
+                if (const uint32_t mask = differ_at(0) & first_bytes(common_size))
+                {
+                    const size_t j = std::countr_zero(mask);
+                    return compare_chars(a[j], b[j]);
+                }
+
+                i = common_size;
+            }
+#endif
+#endif
+        }
+
+        for (; i < common_size; ++i)
+            if (a[i] != b[i])
+                return Detail::compare_chars(a[i], b[i]);
+
+        return (a.size() < b.size()) ? -1 : (a.size() > b.size());
+    }
+} // namespace StringKernels
+
+#endif // STRING_KERNELS_HPP
@@ -1,15 +1,22 @@
 #include <catch2/catch_test_macros.hpp>
+#include <array>
+#include <chrono>
 #include <complex>
+#include <cstdlib>
+#include <deque>
+#include <iomanip>
 #include <iostream>
 #include <list>
 #include <map>
 #include <memory>
 #include <source_location>
+#include <stdexcept>
 #include <string>
 #include <string_view>
 #include <vector>
 #include <numeric>
 #include "../helpers.hpp"
+#include "vectorized_sum.hpp"
 
 using namespace std::literals;
 
@@ -372,10 +379,147 @@ auto sum(const Rng& data)
         std::ranges::range_value_t<Rng>{});
 }
 
+// sized random-access ranges - large ones are reduced in parallel
+template <typename T>
+concept ParallelReducibleRange = AdditiveRange<T> 
+    && std::ranges::random_access_range<T> 
+    && std::ranges::sized_range<T>;
+
+// more constrained - subsumes ParallelReducibleRange
+template <typename T>
+concept ContiguousArithmeticRange = ParallelReducibleRange<T> 
+    && std::ranges::contiguous_range<T> 
+    && std::is_arithmetic_v<std::ranges::range_value_t<T>>;
+
+template <ParallelReducibleRange Rng>
+auto sum(const Rng& data)
+{
+    auto reduce_chunk = [](auto first, size_t size) {
+        return std::accumulate(first, first + size, std::ranges::range_value_t<Rng>{});
+    };
+
+    const size_t size = std::ranges::size(data);
+    if (size >= Kernels::parallel_threshold)
+        return Kernels::parallel_reduce(std::ranges::begin(data), size, reduce_chunk);
+
+    return reduce_chunk(std::ranges::begin(data), size);
+}
+
+template <ContiguousArithmeticRange Rng>
+auto sum(const Rng& data)
+{
+    auto reduce_chunk = [](auto first, size_t size) { return Kernels::simd_sum(first, size); };
+
+    const size_t size = std::ranges::size(data);
+    if (size >= Kernels::parallel_threshold)
+        return Kernels::parallel_reduce(std::ranges::data(data), size, reduce_chunk);
+
+    return reduce_chunk(std::ranges::data(data), size);
+}
+
 TEST_CASE("AdditiveRange")
 { 
     assert(sum(std::vector{1, 2, 3}) == 6);
     //assert(sum(std::vector{ "one", "two", "three" }) == "onetwothree"s);
+
+    SECTION("dispatch")
+    {
+        static_assert(ContiguousArithmeticRange<std::vector<int>>);
+        static_assert(ContiguousArithmeticRange<std::array<double, 4>>);
+        static_assert(ParallelReducibleRange<std::deque<int>> && !ContiguousArithmeticRange<std::deque<int>>);
+        static_assert(ParallelReducibleRange<std::vector<std::string>> && !ContiguousArithmeticRange<std::vector<std::string>>);
+        static_assert(AdditiveRange<std::list<int>> && !ParallelReducibleRange<std::list<int>>);
+
+        CHECK(sum(std::list{1, 2, 3}) == 6);
+        CHECK(sum(std::deque{1, 2, 3}) == 6);
+        CHECK(sum(std::vector{"one"s, "two"s, "three"s}) == "onetwothree");
+        CHECK(sum(std::array{0.5, 1.5, 2.0}) == 4.0);
+    }
+
+    SECTION("SIMD & parallel paths give the same results as std::accumulate")
+    {
+        for (size_t size : {0ul, 1ul, 31ul, 64ul, 1001ul, Kernels::parallel_threshold + 17})
+        {
+            std::vector<int> ints = Helpers::create_numeric_dataset(size, -1000, 1000, Helpers::DatasetOptions{});
+            CHECK(sum(ints) == std::accumulate(ints.begin(), ints.end(), 0));
+
+            std::vector<long long> longs(ints.begin(), ints.end());
+            CHECK(sum(longs) == std::accumulate(longs.begin(), longs.end(), 0LL));
+
+            std::vector<double> doubles(ints.begin(), ints.end()); // small integers - exact in any order
+            CHECK(sum(doubles) == std::accumulate(doubles.begin(), doubles.end(), 0.0));
+
+            std::vector<float> floats(ints.begin(), ints.begin() + std::min<size_t>(size, 1001));
+            CHECK(sum(floats) == std::accumulate(floats.begin(), floats.end(), 0.0f));
+
+            std::deque<int> deq(ints.begin(), ints.end());
+            CHECK(sum(deq) == sum(ints));
+        }
+
+        std::vector<short> shorts(1000, 3); // not vectorized - std::accumulate per chunk
+        CHECK(sum(shorts) == 3000);
+    }
+
+    SECTION("exceptions from parallel chunks are propagated")
+    {
+        struct Throwing
+        {
+            int value = 0;
+
+            Throwing operator+(const Throwing& other) const
+            {
+                if (other.value < 0)
+                    throw std::runtime_error("negative value");
+                return {value + other.value};
+            }
+        };
+
+        std::vector<Throwing> data(Kernels::parallel_threshold, Throwing{1});
+        data.back().value = -1;
+        CHECK_THROWS_AS(sum(data), std::runtime_error);
+
+        // with 1 hardware thread sum() reduces a single chunk in the calling thread - forced chunks:
+        // the last one always runs on a worker thread
+        auto reduce_chunk = [](auto first, size_t size) { return std::accumulate(first, first + size, Throwing{}); };
+        CHECK_THROWS_AS(Kernels::parallel_reduce(data.begin(), data.size(), reduce_chunk, 4), std::runtime_error);
+
+        data.back().value = 1;
+        CHECK(Kernels::parallel_reduce(data.begin(), data.size(), reduce_chunk, 4).value == static_cast<int>(data.size()));
+    }
+}
+
+TEST_CASE("sum - int, float & double - 1K-1G", "[.][benchmark]")
+{
+    // 1G doubles need 8 GB - sizes above 100M are measured only if SUM_BENCHMARK_MAX_SIZE allows
+    const char* max_size_env = std::getenv("SUM_BENCHMARK_MAX_SIZE");
+    const size_t max_size = max_size_env ? std::stoull(max_size_env) : 100'000'000;
+
+    auto run = [&]<typename T>(std::string_view type_name, const std::vector<T>& data) {
+        const size_t no_of_runs = std::max<size_t>(1, 1'000'000'000 / data.size());
+
+        auto measure = [&](std::string_view name, auto reduce) {
+            const auto start = std::chrono::steady_clock::now();
+            T checksum{};
+            for (size_t run = 0; run < no_of_runs; ++run)
+                checksum += reduce();
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+            std::cout << std::setw(10) << data.size() << " " << std::setw(6) << type_name << " - " << std::setw(16) << std::left << name << std::right
+                      << ": " << std::setw(8) << std::fixed << std::setprecision(2) << data.size() * no_of_runs / elapsed.count() / 1e9
+                      << " G elements/s (" << std::defaultfloat << checksum / static_cast<T>(no_of_runs) << ")\n";
+        };
+
+        measure("std::accumulate", [&] { return std::accumulate(data.begin(), data.end(), T{}); });
+        measure("sum", [&] { return sum(data); });
+    };
+
+    for (size_t size = 1'000; size <= std::min<size_t>(max_size, 1'000'000'000); size *= 10)
+    {
+        const std::vector<int> ints = Helpers::create_numeric_dataset(size, -100, 100, Helpers::DatasetOptions{});
+        run("int", ints);
+        run("float", std::vector<float>(ints.begin(), ints.end()));
+        run("double", std::vector<double>(ints.begin(), ints.end()));
+    }
 }
 
 //////////////////////////////////////////////////
@@ -0,0 +1,52 @@
+#ifndef VECTORIZED_SUM_HPP
+#define VECTORIZED_SUM_HPP
+
+#include "../simd_kernels.hpp"
+
+#include <cstddef>
+#include <iterator>
+#include <numeric>
+#include <type_traits>
+
+namespace Kernels
+{
+    ///////////////////////////////////////////////////////////////////////
+    // Building blocks of sum()
+    //  - simd_sum: 4 independent vector accumulators in the element type
+    //    (float, double & 32/64-bit integers; AVX/AVX2 or SSE2) - the order of additions differs from
+    //    std::accumulate, so float results may differ in the last bits; integers wrap around
+    //  - parallel_reduce (simd_kernels.hpp): splits a sized random-access range between threads & combines
+    //    the partial results in order - the operation must be associative (like for std::reduce)
+
+    template <typename T>
+    T simd_sum(const T* first, size_t size)
+    {
+        if constexpr (SimdVectorizable<T>)
+        {
+            using Ops = SimdOps<std::remove_cv_t<T>>;
+            using Vector = typename Ops::Vector;
+            constexpr size_t lanes = lanes_of<T>;
+
+            Vector acc0 = Ops::zero(), acc1 = Ops::zero(), acc2 = Ops::zero(), acc3 = Ops::zero();
+
+            size_t i = 0;
+            for (; i + 4 * lanes <= size; i += 4 * lanes)
+            {
+                acc0 = Ops::add(acc0, Ops::load(first + i));
+                acc1 = Ops::add(acc1, Ops::load(first + i + lanes));
+                acc2 = Ops::add(acc2, Ops::load(first + i + 2 * lanes));
+                acc3 = Ops::add(acc3, Ops::load(first + i + 3 * lanes));
+            }
+
+            std::remove_cv_t<T> partial_sums[lanes];
+            Ops::store(partial_sums, Ops::add(Ops::add(acc0, acc1), Ops::add(acc2, acc3)));
+
+            std::remove_cv_t<T> total = std::accumulate(std::begin(partial_sums), std::end(partial_sums), std::remove_cv_t<T>{});
+            return std::accumulate(first + i, first + size, total);
+        }
+        else
+            return std::accumulate(first, first + size, std::remove_cv_t<T>{});
+    }
+} // namespace Kernels
+
+#endif // VECTORIZED_SUM_HPP
@@ -0,0 +1,40 @@
+#include "allocation_counter.hpp"
+
+#include <cstdlib>
+#include <new>
+
+std::atomic<size_t> AllocationCounter::no_of_allocations{0};
+
+// replaced global allocation functions - count every call to malloc made by operator new
+// (defined in a separate translation unit, so they are never inlined into their callers)
+void* operator new(size_t size)
+{
+    AllocationCounter::no_of_allocations.fetch_add(1, std::memory_order_relaxed);
+
+    if (void* ptr = std::malloc(size == 0 ? 1 : size))
+        return ptr;
+
+    throw std::bad_alloc{};
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    AllocationCounter::no_of_allocations.fetch_add(1, std::memory_order_relaxed);
+
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+    std::free(ptr);
+}
@@ -0,0 +1,20 @@
+#ifndef ALLOCATION_COUNTER_HPP
+#define ALLOCATION_COUNTER_HPP
+
+#include <atomic>
+#include <cstddef>
+
+namespace AllocationCounter
+{
+    // incremented by the replaced global operator new (see allocation_counter.cpp)
+    extern std::atomic<size_t> no_of_allocations;
+
+    size_t count(auto action)
+    {
+        const size_t before = no_of_allocations.load();
+        action();
+        return no_of_allocations.load() - before;
+    }
+} // namespace AllocationCounter
+
+#endif // ALLOCATION_COUNTER_HPP
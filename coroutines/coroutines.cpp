@@ -1,13 +1,35 @@
+#include "../multithreading/thread_pool.hpp"
+#include "allocation_counter.hpp"
+
+#include <array>
+#include <atomic>
 #include <cassert>
+#include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <condition_variable>
 #include <coroutine>
+#include <cstddef>
+#include <deque>
 #include <iostream>
+#include <latch>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <random>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <syncstream>
 #include <thread>
+#include <tuple>
 #include <vector>
 #include <utility>
+#include <variant>
 #include <ranges>
+#include <span>
 
 using namespace std::literals;
 
@@ -113,6 +135,402 @@ TEST_CASE("first coroutine")
     std::cout << "coro() done!\n";
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////
+// lazy, awaitable Task<T> - continuations resumed by a trampoline
+
+namespace Step_2
+{
+    // resumes coroutines one after another in a loop on the current thread - a task that is awaited
+    // or completes hands the next coroutine to the loop instead of resuming it recursively,
+    // so the stack depth stays constant (symmetric transfer gives the same only when the compiler
+    // turns the resumption into a tail call - not guaranteed, e.g. at -O0 or with sanitizers)
+    class Trampoline
+    {
+        static inline thread_local std::coroutine_handle<> next_ = nullptr;
+        static inline thread_local bool is_running_ = false;
+
+    public:
+        static void resume(std::coroutine_handle<> coroutine_hndl)
+        {
+            if (is_running_) // called by a coroutine resumed by the loop - it suspends right after
+            {
+                assert(!next_);
+                next_ = coroutine_hndl;
+                return;
+            }
+
+            is_running_ = true;
+            for (next_ = coroutine_hndl; next_;)
+                std::exchange(next_, nullptr).resume();
+            is_running_ = false;
+        }
+    };
+
+    template <typename T>
+    struct TaskResult
+    {
+        std::optional<T> value_;
+
+        template <typename U = T>
+            requires std::convertible_to<U&&, T>
+        void return_value(U&& value)
+        {
+            value_.emplace(std::forward<U>(value));
+        }
+
+        T get()
+        {
+            return std::move(*value_);
+        }
+    };
+
+    template <>
+    struct TaskResult<void>
+    {
+        void return_void() const noexcept
+        { }
+
+        void get() const noexcept
+        { }
+    };
+
+    template <typename T = void>
+    class [[nodiscard]] Task
+    {
+    public:
+        struct promise_type;
+
+        using CoroutineHandle = std::coroutine_handle<promise_type>;
+
+        struct FinalAwaiter : std::suspend_always
+        {
+            // awaiting coroutine is resumed by the trampoline - without growing the stack
+            void await_suspend(CoroutineHandle coroutine_hndl) noexcept
+            {
+                if (auto continuation = coroutine_hndl.promise().continuation_)
+                    Trampoline::resume(continuation);
+            }
+        };
+
+        struct promise_type : TaskResult<T>
+        {
+            std::coroutine_handle<> continuation_ = nullptr;
+            std::exception_ptr exception_;
+
+            Task get_return_object()
+            {
+                return Task{CoroutineHandle::from_promise(*this)};
+            }
+
+            std::suspend_always initial_suspend() const noexcept { return {}; } // lazy start
+
+            FinalAwaiter final_suspend() const noexcept { return {}; }
+
+            void unhandled_exception() noexcept
+            {
+                exception_ = std::current_exception();
+            }
+
+            T result()
+            {
+                if (exception_)
+                    std::rethrow_exception(exception_);
+
+                return this->get();
+            }
+        };
+
+        struct Awaiter
+        {
+            CoroutineHandle coroutine_hndl_;
+
+            bool await_ready() const noexcept
+            {
+                return !coroutine_hndl_ || coroutine_hndl_.done();
+            }
+
+            // starts the awaited task on the current thread - the caller becomes its continuation
+            void await_suspend(std::coroutine_handle<> awaiting_coroutine) noexcept
+            {
+                coroutine_hndl_.promise().continuation_ = awaiting_coroutine;
+                Trampoline::resume(coroutine_hndl_);
+            }
+
+            T await_resume()
+            {
+                assert(coroutine_hndl_);
+                return coroutine_hndl_.promise().result();
+            }
+        };
+
+        explicit Task(CoroutineHandle coroutine_hndl)
+            : coroutine_hndl_{coroutine_hndl}
+        { }
+
+        Task(const Task&) = delete;
+        Task& operator=(const Task&) = delete;
+
+        Task(Task&& other) noexcept
+            : coroutine_hndl_{std::exchange(other.coroutine_hndl_, nullptr)}
+        { }
+
+        Task& operator=(Task&& other) noexcept
+        {
+            if (this != &other)
+            {
+                if (coroutine_hndl_)
+                    coroutine_hndl_.destroy();
+                coroutine_hndl_ = std::exchange(other.coroutine_hndl_, nullptr);
+            }
+
+            return *this;
+        }
+
+        ~Task()
+        {
+            if (coroutine_hndl_)
+                coroutine_hndl_.destroy();
+        }
+
+        Awaiter operator co_await() const noexcept
+        {
+            return Awaiter{coroutine_hndl_};
+        }
+
+    private:
+        CoroutineHandle coroutine_hndl_;
+    };
+
+    class SyncWaitEvent
+    {
+        std::mutex mtx_;
+        std::condition_variable cv_;
+        bool is_set_ = false;
+
+    public:
+        void set()
+        {
+            std::lock_guard lk{mtx_};
+            is_set_ = true;
+            cv_.notify_one(); // notified under the lock - waiter may destroy the event right after wake-up
+        }
+
+        void wait()
+        {
+            std::unique_lock lk{mtx_};
+            cv_.wait(lk, [this] { return is_set_; });
+        }
+    };
+
+    struct SyncWaiter
+    {
+        struct promise_type;
+
+        using CoroutineHandle = std::coroutine_handle<promise_type>;
+
+        struct promise_type
+        {
+            SyncWaitEvent* event_;
+
+            SyncWaiter get_return_object()
+            {
+                return SyncWaiter{CoroutineHandle::from_promise(*this)};
+            }
+
+            std::suspend_always initial_suspend() const noexcept { return {}; }
+
+            auto final_suspend() const noexcept
+            {
+                struct Signal : std::suspend_always
+                {
+                    void await_suspend(CoroutineHandle coroutine_hndl) const noexcept
+                    {
+                        coroutine_hndl.promise().event_->set();
+                    }
+                };
+
+                return Signal{};
+            }
+
+            void unhandled_exception() { std::terminate(); }
+
+            void return_void() { }
+        };
+
+        CoroutineHandle coroutine_hndl_;
+
+        explicit SyncWaiter(CoroutineHandle coroutine_hndl)
+            : coroutine_hndl_{coroutine_hndl}
+        { }
+
+        SyncWaiter(const SyncWaiter&) = delete;
+        SyncWaiter& operator=(const SyncWaiter&) = delete;
+
+        ~SyncWaiter()
+        {
+            coroutine_hndl_.destroy();
+        }
+
+        void run_and_wait()
+        {
+            SyncWaitEvent event;
+            coroutine_hndl_.promise().event_ = &event;
+            Trampoline::resume(coroutine_hndl_);
+            event.wait();
+        }
+    };
+
+    template <typename T>
+    SyncWaiter make_sync_waiter(Task<T>& task, std::optional<TaskResult<T>>& result, std::exception_ptr& exception)
+    {
+        try
+        {
+            result.emplace();
+            if constexpr (std::is_void_v<T>)
+                co_await task;
+            else
+                result->return_value(co_await task);
+        }
+        catch (...)
+        {
+            exception = std::current_exception();
+        }
+    }
+
+    // blocks the calling thread until the task (which may hop to other threads) completes
+    template <typename T>
+    T sync_wait(Task<T> task)
+    {
+        std::optional<TaskResult<T>> result;
+        std::exception_ptr exception;
+
+        SyncWaiter waiter = make_sync_waiter(task, result, exception);
+        waiter.run_and_wait();
+
+        if (exception)
+            std::rethrow_exception(exception);
+
+        return result->get();
+    }
+} // namespace Step_2
+
+namespace Step_2
+{
+    Task<int> answer()
+    {
+        co_return 42;
+    }
+
+    Task<std::string> describe(int id)
+    {
+        int value = co_await answer();
+        co_return "Task#" + std::to_string(id) + " - " + std::to_string(value);
+    }
+
+    Task<> fail()
+    {
+        throw std::runtime_error("Task failed");
+        co_return;
+    }
+
+    Task<int> one()
+    {
+        co_return 1;
+    }
+
+    // a million awaits of synchronously completing tasks - if each completion resumed
+    // the awaiting coroutine recursively, the stack would overflow
+    Task<int> sum_of_ones(int count)
+    {
+        int sum = 0;
+        for (int i = 0; i < count; ++i)
+            sum += co_await one();
+        co_return sum;
+    }
+
+    Task<int> nested(int depth)
+    {
+        if (depth == 0)
+            co_return 0;
+
+        co_return 1 + co_await nested(depth - 1);
+    }
+} // namespace Step_2
+
+TEST_CASE("Task<T>")
+{
+    using namespace Step_2;
+
+    SECTION("starts lazily")
+    {
+        bool started = false;
+        auto lazy = [&started]() -> Task<> { started = true; co_return; };
+
+        Task<> task = lazy();
+        CHECK_FALSE(started);
+
+        sync_wait(std::move(task));
+        CHECK(started);
+    }
+
+    SECTION("results are passed through co_await")
+    {
+        CHECK(sync_wait(describe(1)) == "Task#1 - 42");
+    }
+
+    SECTION("exceptions are passed through co_await")
+    {
+        auto caller = []() -> Task<bool> {
+            try
+            {
+                co_await fail();
+            }
+            catch (const std::runtime_error&)
+            {
+                co_return true;
+            }
+            co_return false;
+        };
+
+        CHECK(sync_wait(caller()));
+        CHECK_THROWS_AS(sync_wait(fail()), std::runtime_error);
+    }
+
+    SECTION("is movable")
+    {
+        std::vector<Task<int>> tasks;
+        tasks.push_back(answer());
+        tasks.push_back(one());
+
+        Task<int> task = std::move(tasks.front());
+        CHECK(sync_wait(std::move(task)) == 42);
+    }
+
+    SECTION("a million awaits run in constant stack")
+    {
+        constexpr int no_of_awaits = 1'000'000;
+
+        const auto start = std::chrono::steady_clock::now();
+        CHECK(sync_wait(sum_of_ones(no_of_awaits)) == no_of_awaits);
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        std::cout << "Task<T> - sequential awaits: "
+                  << std::chrono::duration<double, std::nano>(elapsed).count() / no_of_awaits << "ns per await\n";
+    }
+
+    SECTION("a million nested awaits run in constant stack")
+    {
+        constexpr int depth = 1'000'000;
+
+        const auto start = std::chrono::steady_clock::now();
+        CHECK(sync_wait(nested(depth)) == depth);
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        std::cout << "Task<T> - nested awaits: "
+                  << std::chrono::duration<double, std::nano>(elapsed).count() / depth << "ns per await\n";
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////
 // custom Awaiter
 
@@ -201,47 +619,477 @@ FireAndForget coro_on_many_threads(int id)
 // }
 
 ////////////////////////////////////////////////////////////////////
-//
+// scheduling coroutines on an executor
 
-namespace FutureStd
-{
+template <typename T>
+concept Executor = requires(T& executor, void (*task)()) {
+    executor.submit(task);
+};
 
-    template <typename T>
-    class [[nodiscard]] Generator
+template <Executor TExecutor>
+auto schedule_on(TExecutor& executor)
+{
+    // Awaiter - suspended coroutine is queued & resumed by one of the executor's threads
+    struct ScheduleOnAwaiter : std::suspend_always
     {
-    public:
-        struct promise_type;
+        TExecutor* executor_;
 
-        using CoroutineHandle = std::coroutine_handle<promise_type>;
+        void await_suspend(std::coroutine_handle<> coroutine_hndl)
+        {
+            executor_->submit([coroutine_hndl] { coroutine_hndl.resume(); });
+        }
 
-        struct promise_type
+        std::thread::id await_resume() const noexcept
         {
-            Generator get_return_object()
-            {
-                return Generator{CoroutineHandle::from_promise(*this)};
-            }
+            return std::this_thread::get_id();
+        }
+    };
 
-            std::suspend_always initial_suspend() const { return {}; }
+    return ScheduleOnAwaiter{{}, &executor};
+}
 
-            std::suspend_always final_suspend() const noexcept { return {}; }
+FireAndForget coro_on_many_threads(int id, Executor auto& executor, std::latch& done)
+{
+    const int max_step = 3;
+    int step = 1;
+    sync_out() << "Coro#" << id << " - Part#" << step << "/" << max_step << " - started on THD#" << std::this_thread::get_id() << "\n";
 
-            void unhandled_exception() { std::terminate(); }
+    std::thread::id thd_id = co_await schedule_on(executor);
 
-            std::suspend_always yield_value(auto&& yielded_value)
-            {
-                value = std::forward<decltype(yielded_value)>(yielded_value);
-                return {};
-            }
+    ++step;
+    sync_out() << "Coro#" << id << " - Part#" << step << "/" << max_step << " - continues on THD#" << std::this_thread::get_id() << "\n";
+    assert(thd_id == std::this_thread::get_id());
 
-            void return_void() { }
+    thd_id = co_await schedule_on(executor); /////////////////////////////////// context switch
 
-            T value;
-        };
+    ++step;
+    sync_out() << "Coro#" << id << " - Part#" << step << "/" << max_step << " - ends on THD#" << std::this_thread::get_id() << "\n";
+    assert(thd_id == std::this_thread::get_id());
 
-        struct iterator
-        {
-            using value_type = T;
-            using reference = T;
+    done.count_down();
+}
+
+TEST_CASE("resume part of the function on the thread pool")
+{
+    Concurrency::ThreadPool pool{2};
+    std::latch done{3};
+
+    coro_on_many_threads(1, pool, done);
+    coro_on_many_threads(2, pool, done);
+    coro_on_many_threads(3, pool, done);
+
+    done.wait();
+}
+
+namespace Benchmarks
+{
+    struct Detached
+    {
+        struct promise_type
+        {
+            Detached get_return_object() noexcept { return {}; }
+            std::suspend_never initial_suspend() const noexcept { return {}; }
+            std::suspend_never final_suspend() const noexcept { return {}; }
+            void unhandled_exception() { std::terminate(); }
+            void return_void() const noexcept { }
+        };
+    };
+
+    // quiet version of coro_on_many_threads - measures the time between suspension & resumption
+    Detached switch_threads(auto schedule, std::shared_ptr<std::latch> done, std::atomic<int64_t>& switch_time_ns)
+    {
+        for (int step = 0; step < 2; ++step)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            co_await schedule();
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+            switch_time_ns.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(), std::memory_order_relaxed);
+        }
+
+        done->count_down();
+    }
+
+    void run_switching_coroutines(int no_of_coroutines, auto schedule, std::atomic<int64_t>& switch_time_ns)
+    {
+        auto done = std::make_shared<std::latch>(no_of_coroutines);
+
+        for (int i = 0; i < no_of_coroutines; ++i)
+            switch_threads(schedule, done, switch_time_ns);
+
+        done->wait();
+    }
+} // namespace Benchmarks
+
+TEST_CASE("schedule_on(thread pool) vs. resume_on_new_thread", "[.][benchmark]")
+{
+    constexpr int no_of_coroutines = 10'000;
+    constexpr int no_of_switches = 2 * no_of_coroutines;
+
+    Concurrency::ThreadPool pool;
+
+    std::atomic<int64_t> switch_time_ns{0};
+    int no_of_runs = 0;
+
+    // benchmarks are skipped with --skip-benchmarks - nothing to report then
+    auto report_latency = [&](std::string_view name) {
+        if (no_of_runs > 0)
+            std::cout << name << " - avg. context switch latency: " << switch_time_ns / (no_of_runs * no_of_switches) << "ns\n";
+    };
+
+    BENCHMARK("resume_on_new_thread - 10k coroutines")
+    {
+        ++no_of_runs;
+        Benchmarks::run_switching_coroutines(no_of_coroutines, [] { return resume_on_new_thread(); }, switch_time_ns);
+    };
+    report_latency("resume_on_new_thread");
+
+    switch_time_ns = 0;
+    no_of_runs = 0;
+
+    BENCHMARK("schedule_on(thread pool) - 10k coroutines")
+    {
+        ++no_of_runs;
+        Benchmarks::run_switching_coroutines(no_of_coroutines, [&pool] { return schedule_on(pool); }, switch_time_ns);
+    };
+    report_latency("schedule_on(thread pool)");
+}
+
+////////////////////////////////////////////////////////////////////
+//
+
+namespace FutureStd
+{
+    namespace Detail
+    {
+        // thread-local free-lists of coroutine frames grouped in size classes
+        class FramePool
+        {
+            static constexpr size_t granularity = 64;
+            static constexpr size_t no_of_size_classes = 16; // frames up to 1 KB are pooled
+
+            struct FreeBlock
+            {
+                FreeBlock* next;
+            };
+
+            std::array<FreeBlock*, no_of_size_classes> free_lists_{};
+
+            FramePool() = default;
+
+        public:
+            FramePool(const FramePool&) = delete;
+            FramePool& operator=(const FramePool&) = delete;
+
+            ~FramePool()
+            {
+                for (FreeBlock*& head : free_lists_)
+                    while (head)
+                        ::operator delete(std::exchange(head, head->next));
+            }
+
+            static FramePool& this_thread()
+            {
+                thread_local FramePool pool;
+                return pool;
+            }
+
+            void* allocate(size_t size)
+            {
+                const size_t size_class = (size - 1) / granularity;
+
+                if (size_class >= no_of_size_classes)
+                    return ::operator new(size);
+
+                if (FreeBlock* block = free_lists_[size_class])
+                {
+                    free_lists_[size_class] = block->next;
+                    return block;
+                }
+
+                return ::operator new((size_class + 1) * granularity);
+            }
+
+            void deallocate(void* ptr, size_t size) noexcept
+            {
+                const size_t size_class = (size - 1) / granularity;
+
+                if (size_class >= no_of_size_classes)
+                {
+                    ::operator delete(ptr);
+                    return;
+                }
+
+                free_lists_[size_class] = ::new (ptr) FreeBlock{free_lists_[size_class]};
+            }
+        };
+
+        constexpr size_t align_up(size_t size, size_t alignment)
+        {
+            return (size + alignment - 1) & ~(alignment - 1);
+        }
+
+        // Base for promise types - coroutine frames are taken from the thread-local FramePool
+        // or, when the coroutine's leading arguments are (std::allocator_arg, alloc, ...), from alloc.
+        // The deallocation function (and a copy of the allocator) are stored behind the frame.
+        class PooledFrame
+        {
+            using DeallocateFn = void (*)(void* frame, size_t size) noexcept;
+
+            static constexpr size_t dealloc_fn_offset(size_t frame_size)
+            {
+                return align_up(frame_size, alignof(DeallocateFn));
+            }
+
+            template <typename TAlloc>
+            static constexpr size_t allocator_offset(size_t frame_size)
+            {
+                return align_up(dealloc_fn_offset(frame_size) + sizeof(DeallocateFn), alignof(TAlloc));
+            }
+
+            template <typename TAlloc>
+            static constexpr size_t allocation_size(size_t frame_size)
+            {
+                return allocator_offset<TAlloc>(frame_size) + sizeof(TAlloc);
+            }
+
+            static void deallocate_pooled(void* frame, size_t size) noexcept
+            {
+                FramePool::this_thread().deallocate(frame, dealloc_fn_offset(size) + sizeof(DeallocateFn));
+            }
+
+            template <typename TAlloc>
+            static void deallocate_with_allocator(void* frame, size_t size) noexcept
+            {
+                auto* stored_alloc = std::launder(reinterpret_cast<TAlloc*>(static_cast<std::byte*>(frame) + allocator_offset<TAlloc>(size)));
+                TAlloc alloc = std::move(*stored_alloc);
+                stored_alloc->~TAlloc();
+
+                const size_t no_of_bytes = align_up(allocation_size<TAlloc>(size), sizeof(std::max_align_t));
+                alloc.deallocate(static_cast<std::max_align_t*>(frame), no_of_bytes / sizeof(std::max_align_t));
+            }
+
+            static void store_dealloc_fn(void* frame, size_t size, DeallocateFn dealloc_fn) noexcept
+            {
+                ::new (static_cast<std::byte*>(frame) + dealloc_fn_offset(size)) DeallocateFn{dealloc_fn};
+            }
+
+        public:
+            static void* operator new(size_t size)
+            {
+                void* frame = FramePool::this_thread().allocate(dealloc_fn_offset(size) + sizeof(DeallocateFn));
+                store_dealloc_fn(frame, size, &deallocate_pooled);
+                return frame;
+            }
+
+            template <typename TAllocArg, typename... TArgs>
+            static void* operator new(size_t size, std::allocator_arg_t, TAllocArg& alloc_arg, TArgs&...)
+            {
+                using TAlloc = typename std::allocator_traits<std::remove_cvref_t<TAllocArg>>::template rebind_alloc<std::max_align_t>;
+
+                TAlloc alloc(alloc_arg);
+                const size_t no_of_bytes = align_up(allocation_size<TAlloc>(size), sizeof(std::max_align_t));
+                void* frame = alloc.allocate(no_of_bytes / sizeof(std::max_align_t));
+
+                ::new (static_cast<std::byte*>(frame) + allocator_offset<TAlloc>(size)) TAlloc(std::move(alloc));
+                store_dealloc_fn(frame, size, &deallocate_with_allocator<TAlloc>);
+                return frame;
+            }
+
+            static void operator delete(void* frame, size_t size) noexcept
+            {
+                DeallocateFn dealloc_fn = *std::launder(reinterpret_cast<DeallocateFn*>(static_cast<std::byte*>(frame) + dealloc_fn_offset(size)));
+                dealloc_fn(frame, size);
+            }
+        };
+    } // namespace Detail
+
+    template <std::ranges::input_range TRange>
+    struct elements_of
+    {
+        TRange range;
+    };
+
+    template <typename TRange>
+    elements_of(TRange&&) -> elements_of<TRange&&>;
+
+    // Generator<Ref, Val> - like std::generator: promise stores a pointer to the yielded object
+    // (kept alive in the suspended frame) & the iterator returns a reference to it
+    //  - Generator<T>           - reference: T&&, lvalues are copied once when yielded
+    //  - Generator<const T&>    - reference: const T&, lvalues & rvalues are never copied
+    template <typename TRef, typename TVal = void>
+    class [[nodiscard]] Generator
+    {
+    public:
+        using value_type = std::conditional_t<std::is_void_v<TVal>, std::remove_cvref_t<TRef>, TVal>;
+        using reference = std::conditional_t<std::is_void_v<TVal>, TRef&&, TRef>;
+        using yielded = std::conditional_t<std::is_reference_v<reference>, reference, const reference&>;
+
+        struct promise_type;
+
+        using CoroutineHandle = std::coroutine_handle<promise_type>;
+
+        struct promise_type : Detail::PooledFrame
+        {
+            Generator get_return_object()
+            {
+                return Generator{CoroutineHandle::from_promise(*this)};
+            }
+
+            std::suspend_always initial_suspend() const { return {}; }
+
+            // nested generator transfers control back to its parent
+            auto final_suspend() const noexcept
+            {
+                struct FinalAwaiter : std::suspend_always
+                {
+                    std::coroutine_handle<> await_suspend(CoroutineHandle coroutine_hndl) noexcept
+                    {
+                        promise_type& promise = coroutine_hndl.promise();
+
+                        if (!promise.parent_)
+                            return std::noop_coroutine();
+
+                        promise.root_->active_ = promise.parent_;
+                        return CoroutineHandle::from_promise(*promise.parent_);
+                    }
+                };
+
+                return FinalAwaiter{};
+            }
+
+            void unhandled_exception() { std::terminate(); }
+
+            // in batch mode (next_batch()) the generator is suspended only when the batch is full
+            struct YieldAwaiter
+            {
+                bool suspend_ = true;
+
+                bool await_ready() const noexcept { return !suspend_; }
+                void await_suspend(std::coroutine_handle<>) const noexcept { }
+                void await_resume() const noexcept { }
+            };
+
+            YieldAwaiter yield_value(yielded yielded_value) noexcept(std::is_nothrow_assignable_v<value_type&, reference>)
+            {
+                if constexpr (std::is_assignable_v<value_type&, reference>)
+                {
+                    if (root_->is_batching())
+                        return YieldAwaiter{root_->push_to_batch(static_cast<reference>(yielded_value))};
+                }
+
+                value_ptr_ = std::addressof(yielded_value);
+                return {};
+            }
+
+            // lvalue yielded to Generator<T> - the copy lives in the awaiter until the generator is resumed
+            auto yield_value(const std::remove_reference_t<yielded>& lvalue)
+                requires std::is_rvalue_reference_v<yielded>
+                && std::constructible_from<std::remove_cvref_t<yielded>, const std::remove_reference_t<yielded>&>
+            {
+                struct CopyAwaiter : YieldAwaiter
+                {
+                    std::optional<std::remove_cvref_t<yielded>> copy_;
+
+                    void await_suspend(CoroutineHandle coroutine_hndl) noexcept
+                    {
+                        if (copy_)
+                            coroutine_hndl.promise().value_ptr_ = std::addressof(*copy_);
+                    }
+                };
+
+                if constexpr (std::is_assignable_v<value_type&, decltype(lvalue)>)
+                {
+                    if (root_->is_batching())
+                        return CopyAwaiter{{root_->push_to_batch(lvalue)}, std::nullopt};
+                }
+
+                return CopyAwaiter{{}, lvalue};
+            }
+
+            // co_yield elements_of(generator) - the nested generator becomes the active one
+            // & the consumer resumes it directly: O(1) resumes per element at any depth
+            auto yield_value(elements_of<Generator&&> nested)
+            {
+                struct NestedAwaiter
+                {
+                    Generator nested_;
+
+                    bool await_ready() const noexcept
+                    {
+                        return !nested_.coroutine_hndl_ || nested_.coroutine_hndl_.done();
+                    }
+
+                    std::coroutine_handle<> await_suspend(CoroutineHandle coroutine_hndl) noexcept
+                    {
+                        promise_type& parent = coroutine_hndl.promise();
+                        promise_type& child = nested_.coroutine_hndl_.promise();
+
+                        child.parent_ = &parent;
+                        child.root_ = parent.root_;
+                        parent.root_->active_ = &child;
+
+                        return nested_.coroutine_hndl_;
+                    }
+
+                    void await_resume() const noexcept
+                    { }
+                };
+
+                return NestedAwaiter{std::move(nested.range)};
+            }
+
+            template <std::ranges::input_range TRange>
+            auto yield_value(elements_of<TRange> nested)
+            {
+                auto range_elements = [](std::ranges::iterator_t<TRange> first, std::ranges::sentinel_t<TRange> last) -> Generator {
+                    for (; first != last; ++first)
+                        co_yield *first;
+                };
+
+                return yield_value(elements_of{range_elements(std::ranges::begin(nested.range), std::ranges::end(nested.range))});
+            }
+
+            void return_void() { }
+
+        private:
+            friend class Generator;
+
+            promise_type* root_ = this;
+            promise_type* parent_ = nullptr;
+            promise_type* active_ = this; // innermost generator - valid for the root only
+            std::add_pointer_t<yielded> value_ptr_ = nullptr;
+            std::span<value_type> batch_;      // caller-provided buffer - valid for the root only
+            size_t batch_size_ = 0;
+
+            bool is_batching() const noexcept
+            {
+                return !batch_.empty();
+            }
+
+            // returns true when the batch is full & the generator should be suspended
+            template <typename TValue>
+            bool push_to_batch(TValue&& value)
+            {
+                batch_[batch_size_++] = std::forward<TValue>(value);
+                return batch_size_ == batch_.size();
+            }
+
+            promise_type& active() const noexcept
+            {
+                return *root_->active_;
+            }
+
+            void resume_active()
+            {
+                CoroutineHandle::from_promise(active()).resume();
+            }
+        };
+
+        struct iterator
+        {
+            using value_type = Generator::value_type;
+            using reference = Generator::reference;
+            using difference_type = std::ptrdiff_t;
             using iterator_category = std::input_iterator_tag;
 
             CoroutineHandle coroutine_handle_ = nullptr;
@@ -252,16 +1100,16 @@ namespace FutureStd
                 : coroutine_handle_{coroutine_handle}
             { }
 
-            T operator*() const
+            reference operator*() const
             {
                 assert(coroutine_handle_ != nullptr);
-                return coroutine_handle_.promise().value;
+                return static_cast<reference>(*coroutine_handle_.promise().active().value_ptr_);
             }
 
-            T* operator->() const
+            auto operator->() const
             {
                 assert(coroutine_handle_ != nullptr);
-                return &coroutine_handle_.promise().value;
+                return coroutine_handle_.promise().active().value_ptr_;
             }
 
             iterator& operator++()
@@ -286,7 +1134,7 @@ namespace FutureStd
             {
                 if (coroutine_handle_ && !coroutine_handle_.done())
                 {
-                    coroutine_handle_.resume();
+                    coroutine_handle_.promise().resume_active();
 
                     if (coroutine_handle_.done())
                     {
@@ -303,24 +1151,51 @@ namespace FutureStd
         Generator(const Generator&) = delete;
         Generator& operator=(const Generator&) = delete;
 
+        Generator(Generator&& other) noexcept
+            : coroutine_hndl_{std::exchange(other.coroutine_hndl_, nullptr)}
+        { }
+
+        Generator& operator=(Generator&&) = delete;
+
         ~Generator()
         {
             if (coroutine_hndl_)
                 coroutine_hndl_.destroy();
         }
 
-        std::optional<T> next_value()
+        std::optional<value_type> next_value()
         {
             assert(coroutine_hndl_);
             // if (!coroutine_hndl_ || coroutine_hndl_.done())
             //     return std::nullopt;
 
-            coroutine_hndl_.resume();
+            coroutine_hndl_.promise().resume_active();
 
             if (coroutine_hndl_.done())
                 return std::nullopt;
 
-            return coroutine_hndl_.promise().value;
+            return static_cast<reference>(*coroutine_hndl_.promise().active().value_ptr_);
+        }
+
+        // fills the buffer resuming the generator once per batch - returns the filled part of the buffer
+        std::span<value_type> next_batch(std::span<value_type> buffer)
+            requires std::is_assignable_v<value_type&, reference>
+        {
+            assert(coroutine_hndl_);
+
+            if (coroutine_hndl_.done() || buffer.empty())
+                return {};
+
+            promise_type& promise = coroutine_hndl_.promise();
+            promise.batch_ = buffer;
+            promise.batch_size_ = 0;
+
+            promise.resume_active();
+
+            const size_t batch_size = std::exchange(promise.batch_size_, 0);
+            promise.batch_ = {};
+
+            return buffer.first(batch_size);
         }
 
         iterator begin() const
@@ -329,7 +1204,7 @@ namespace FutureStd
                 return {};
 
             iterator it{coroutine_hndl_};
-            it.next();
+            it.move_to_next();
             return it;
         }
 
@@ -359,6 +1234,7 @@ namespace FutureStd
 } // namespace FutureStd
 
 using FutureStd::Generator;
+using FutureStd::elements_of;
 
 Generator<int> fibonacci(int n)
 {
@@ -368,6 +1244,25 @@ Generator<int> fibonacci(int n)
         co_yield std::exchange(a, std::exchange(b, a + b));
 }
 
+// coroutine frame is allocated with alloc (alloc is used only by the promise's operator new)
+//  - gcc pairs the frame's sized operator delete with the operator new template & reports a mismatch,
+//    although PooledFrame::operator delete dispatches to the deallocation function stored behind the frame
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+template <typename TAlloc>
+Generator<int> fibonacci(std::allocator_arg_t, [[maybe_unused]] TAlloc alloc, int n)
+{
+    auto a = 0, b = 1;
+
+    while (a < n)
+        co_yield std::exchange(a, std::exchange(b, a + b));
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
 namespace views = std::ranges::views;
 
 TEST_CASE("fibonacci with generator")
@@ -375,4 +1270,1235 @@ TEST_CASE("fibonacci with generator")
     for (const auto& item : fibonacci(100))
         std::cout << item << " ";
     std::cout << "\n";
-}
\ No newline at end of file
+}
+
+////////////////////////////////////////////////////////////////////
+// pooled coroutine frames
+
+TEST_CASE("Generator - pooled frame allocation")
+{
+    constexpr int no_of_generators = 10'000;
+
+    auto consume = [](Generator<int> gen) {
+        int sum = 0;
+        for (int item : gen)
+            sum += item;
+        return sum;
+    };
+
+    SECTION("frames are reused from the thread-local pool")
+    {
+        int sum = 0;
+        const size_t no_of_mallocs = AllocationCounter::count([&] {
+            for (int i = 0; i < no_of_generators; ++i)
+                sum += consume(fibonacci(100));
+        });
+
+        CHECK(sum == 232 * no_of_generators);
+        CHECK(no_of_mallocs <= 1);
+    }
+
+    SECTION("frames are allocated with an allocator passed as a leading argument")
+    {
+        int sum = 0;
+        const size_t no_of_mallocs = AllocationCounter::count([&] {
+            for (int i = 0; i < no_of_generators; ++i)
+                sum += consume(fibonacci(std::allocator_arg, std::allocator<std::byte>{}, 100));
+        });
+
+        CHECK(sum == 232 * no_of_generators);
+        CHECK(no_of_mallocs == no_of_generators);
+    }
+
+    SECTION("polymorphic allocator")
+    {
+        std::array<std::byte, 4096> buffer;
+        std::pmr::monotonic_buffer_resource arena{buffer.data(), buffer.size(), std::pmr::null_memory_resource()};
+
+        int sum = 0;
+        const size_t no_of_mallocs = AllocationCounter::count([&] {
+            sum = consume(fibonacci(std::allocator_arg, std::pmr::polymorphic_allocator<std::byte>{&arena}, 100));
+        });
+
+        CHECK(sum == 232);
+        CHECK(no_of_mallocs == 0);
+    }
+}
+
+TEST_CASE("Generator - pooled frame allocation - benchmark", "[.][benchmark]")
+{
+    constexpr int no_of_generators = 1'000'000;
+
+    auto create_generators = [](auto make_generator) {
+        int sum = 0;
+        for (int i = 0; i < no_of_generators; ++i)
+            for (int item : make_generator())
+                sum += item;
+        return sum;
+    };
+
+    auto with_global_new = [] { return fibonacci(std::allocator_arg, std::allocator<std::byte>{}, 100); };
+    auto with_frame_pool = [] { return fibonacci(100); };
+
+    std::cout << "mallocs for 1M generators - global operator new: " << AllocationCounter::count([&] { create_generators(with_global_new); })
+              << ", frame pool: " << AllocationCounter::count([&] { create_generators(with_frame_pool); }) << "\n";
+
+    BENCHMARK("1M fibonacci generators - global operator new")
+    {
+        return create_generators(with_global_new);
+    };
+
+    BENCHMARK("1M fibonacci generators - frame pool")
+    {
+        return create_generators(with_frame_pool);
+    };
+}
+
+////////////////////////////////////////////////////////////////////
+// recursive generators - elements_of
+
+namespace RecursiveGenerators
+{
+    struct TreeNode
+    {
+        int value;
+        std::unique_ptr<TreeNode> left;
+        std::unique_ptr<TreeNode> right;
+    };
+
+    std::unique_ptr<TreeNode> make_tree(int first, int last) // balanced BST with values [first, last)
+    {
+        if (first >= last)
+            return nullptr;
+
+        const int middle = first + (last - first) / 2;
+        return std::make_unique<TreeNode>(middle, make_tree(first, middle), make_tree(middle + 1, last));
+    }
+
+    std::unique_ptr<TreeNode> make_left_chain(int depth) // degenerated tree: depth nodes with values [0, depth)
+    {
+        std::unique_ptr<TreeNode> root;
+        for (int value = depth - 1; value >= 0; --value)
+            root = std::make_unique<TreeNode>(value, std::move(root), nullptr);
+        return root;
+    }
+
+    Generator<int> in_order(const TreeNode* node)
+    {
+        if (!node)
+            co_return;
+
+        co_yield elements_of(in_order(node->left.get()));
+        co_yield node->value;
+        co_yield elements_of(in_order(node->right.get()));
+    }
+
+    // every element is re-yielded by all the enclosing generators - O(depth) resumes per element
+    Generator<int> in_order_by_value(const TreeNode* node)
+    {
+        if (!node)
+            co_return;
+
+        for (int value : in_order_by_value(node->left.get()))
+            co_yield value;
+        co_yield node->value;
+        for (int value : in_order_by_value(node->right.get()))
+            co_yield value;
+    }
+
+    Generator<int> flatten(const std::vector<std::vector<int>>& nested)
+    {
+        for (const auto& items : nested)
+            co_yield elements_of(items);
+    }
+} // namespace RecursiveGenerators
+
+TEST_CASE("Generator - elements_of")
+{
+    using namespace RecursiveGenerators;
+
+    static_assert(std::ranges::input_range<Generator<int>>);
+
+    SECTION("in-order traversal of a tree")
+    {
+        auto tree = make_tree(0, 100);
+
+        std::vector<int> values;
+        for (int value : in_order(tree.get()))
+            values.push_back(value);
+
+        CHECK(std::ranges::equal(values, std::views::iota(0, 100)));
+    }
+
+    SECTION("depth-1000 traversal")
+    {
+        auto chain = make_left_chain(1000);
+
+        std::vector<int> values;
+        for (int value : in_order(chain.get()))
+            values.push_back(value);
+
+        CHECK(std::ranges::equal(values, std::views::iota(0, 1000) | std::views::reverse));
+    }
+
+    SECTION("elements of a range")
+    {
+        std::vector<std::vector<int>> nested = {{1, 2}, {}, {3}, {4, 5, 6}};
+
+        auto gen = flatten(nested);
+        std::vector<int> values;
+        while (auto value = gen.next_value())
+            values.push_back(*value);
+
+        CHECK(values == std::vector{1, 2, 3, 4, 5, 6});
+    }
+
+    SECTION("empty nested generator")
+    {
+        auto gen = in_order(nullptr);
+        CHECK(gen.begin() == gen.end());
+    }
+}
+
+TEST_CASE("Generator - elements_of - benchmark", "[.][benchmark]")
+{
+    using namespace RecursiveGenerators;
+
+    auto chain = make_left_chain(1000);
+
+    BENCHMARK("depth-1000 traversal - co_yield elements_of")
+    {
+        int sum = 0;
+        for (int value : in_order(chain.get()))
+            sum += value;
+        return sum;
+    };
+
+    BENCHMARK("depth-1000 traversal - co_yield each value")
+    {
+        int sum = 0;
+        for (int value : in_order_by_value(chain.get()))
+            sum += value;
+        return sum;
+    };
+}
+
+////////////////////////////////////////////////////////////////////
+// reference-yielding generators
+
+namespace ReferenceYielding
+{
+    struct Payload
+    {
+        static inline int no_of_copies = 0;
+
+        std::string data;
+
+        explicit Payload(std::string data)
+            : data{std::move(data)}
+        { }
+
+        Payload(const Payload& other)
+            : data{other.data}
+        {
+            ++no_of_copies;
+        }
+
+        Payload(Payload&&) noexcept = default;
+    };
+
+    Generator<const Payload&> view_of(const std::vector<Payload>& items)
+    {
+        for (const auto& item : items)
+            co_yield item;
+    }
+
+    Generator<Payload> copies_of(const std::vector<Payload>& items)
+    {
+        for (const auto& item : items)
+            co_yield item;
+    }
+
+    Generator<Payload> make_payloads(int count)
+    {
+        for (int i = 0; i < count; ++i)
+            co_yield Payload{std::to_string(i)};
+    }
+
+    Generator<std::string&> words_of(std::vector<std::string>& words)
+    {
+        for (auto& word : words)
+            co_yield word;
+    }
+
+    // previous version of Generator<T> - the yielded value is assigned to the promise & returned by value
+    template <typename T>
+    class CopyingGenerator
+    {
+    public:
+        struct promise_type
+        {
+            T value;
+
+            CopyingGenerator get_return_object() { return CopyingGenerator{std::coroutine_handle<promise_type>::from_promise(*this)}; }
+            std::suspend_always initial_suspend() const { return {}; }
+            std::suspend_always final_suspend() const noexcept { return {}; }
+            void unhandled_exception() { std::terminate(); }
+            void return_void() { }
+
+            std::suspend_always yield_value(auto&& yielded_value)
+            {
+                value = std::forward<decltype(yielded_value)>(yielded_value);
+                return {};
+            }
+        };
+
+        explicit CopyingGenerator(std::coroutine_handle<promise_type> coroutine_hndl)
+            : coroutine_hndl_{coroutine_hndl}
+        { }
+
+        CopyingGenerator(const CopyingGenerator&) = delete;
+        CopyingGenerator& operator=(const CopyingGenerator&) = delete;
+
+        ~CopyingGenerator()
+        {
+            coroutine_hndl_.destroy();
+        }
+
+        std::optional<T> next_value()
+        {
+            coroutine_hndl_.resume();
+
+            if (coroutine_hndl_.done())
+                return std::nullopt;
+
+            return coroutine_hndl_.promise().value;
+        }
+
+    private:
+        std::coroutine_handle<promise_type> coroutine_hndl_;
+    };
+
+    CopyingGenerator<std::string> copying_strings(const std::vector<std::string>& items)
+    {
+        for (const auto& item : items)
+            co_yield item;
+    }
+
+    Generator<const std::string&> referenced_strings(const std::vector<std::string>& items)
+    {
+        for (const auto& item : items)
+            co_yield item;
+    }
+} // namespace ReferenceYielding
+
+TEST_CASE("Generator - yielding references")
+{
+    using namespace ReferenceYielding;
+
+    std::vector<Payload> items;
+    for (int i = 0; i < 100; ++i)
+        items.emplace_back(std::string(1024, 'a' + i % 26));
+
+    Payload::no_of_copies = 0;
+
+    SECTION("Generator<const T&> - yielded lvalues are not copied")
+    {
+        size_t total_size = 0;
+        for (const Payload& item : view_of(items))
+            total_size += item.data.size();
+
+        CHECK(total_size == 100 * 1024);
+        CHECK(Payload::no_of_copies == 0);
+    }
+
+    SECTION("Generator<T> - yielded lvalue is copied once")
+    {
+        size_t total_size = 0;
+        for (Payload&& item : copies_of(items))
+            total_size += item.data.size();
+
+        CHECK(total_size == 100 * 1024);
+        CHECK(Payload::no_of_copies == 100);
+    }
+
+    SECTION("Generator<T> - yielded rvalues are not copied")
+    {
+        std::vector<Payload> payloads;
+        for (Payload&& item : make_payloads(10))
+            payloads.push_back(std::move(item));
+
+        CHECK(payloads.size() == 10);
+        CHECK(payloads.back().data == "9");
+        CHECK(Payload::no_of_copies == 0);
+    }
+
+    SECTION("Generator<T&> - yielded objects can be modified")
+    {
+        std::vector<std::string> words = {"one", "two", "three"};
+
+        for (std::string& word : words_of(words))
+            word += "!";
+
+        CHECK(words == std::vector<std::string>{"one!", "two!", "three!"});
+    }
+}
+
+TEST_CASE("Generator - yielding references - benchmark", "[.][benchmark]")
+{
+    using namespace ReferenceYielding;
+
+    const std::vector<std::string> items(10'000, std::string(1024, 'x'));
+
+    BENCHMARK("1 KB strings - value stored in promise & returned by value")
+    {
+        size_t total_size = 0;
+        auto gen = copying_strings(items);
+        while (auto item = gen.next_value())
+            total_size += item->size();
+        return total_size;
+    };
+
+    BENCHMARK("1 KB strings - Generator<const std::string&>")
+    {
+        size_t total_size = 0;
+        for (const std::string& item : referenced_strings(items))
+            total_size += item.size();
+        return total_size;
+    };
+}
+
+////////////////////////////////////////////////////////////////////
+// batched consumption of generators
+
+Generator<uint64_t> fibonacci_sequence(size_t count)
+{
+    uint64_t a = 0, b = 1;
+
+    for (size_t i = 0; i < count; ++i)
+        co_yield std::exchange(a, std::exchange(b, a + b)); // wraps around for large count
+}
+
+TEST_CASE("Generator - next_batch")
+{
+    std::vector<int> expected;
+    for (int item : fibonacci(1000))
+        expected.push_back(item);
+
+    SECTION("generator is resumed once per batch")
+    {
+        auto gen = fibonacci(1000);
+
+        std::array<int, 4> buffer;
+        std::vector<int> values;
+        std::vector<size_t> batch_sizes;
+
+        for (auto batch = gen.next_batch(buffer); !batch.empty(); batch = gen.next_batch(buffer))
+        {
+            values.insert(values.end(), batch.begin(), batch.end());
+            batch_sizes.push_back(batch.size());
+        }
+
+        CHECK(values == expected);
+        CHECK(batch_sizes == std::vector<size_t>{4, 4, 4, 4, 1});
+    }
+
+    SECTION("batches & single values can be mixed")
+    {
+        auto gen = fibonacci(1000);
+
+        std::array<int, 8> buffer;
+        std::vector<int> values;
+
+        auto batch = gen.next_batch(buffer);
+        values.insert(values.end(), batch.begin(), batch.end());
+        values.push_back(*gen.next_value());
+        batch = gen.next_batch(buffer);
+        values.insert(values.end(), batch.begin(), batch.end());
+
+        CHECK(values == expected);
+    }
+
+    SECTION("nested generators & copied lvalues")
+    {
+        std::vector<std::vector<int>> nested = {{1, 2, 3}, {}, {4, 5}};
+
+        auto gen = [](const auto& nested) -> Generator<int> {
+            co_yield 0;
+            for (const auto& items : nested)
+                co_yield elements_of(items);
+            const int last = 6;
+            co_yield last;
+        }(nested);
+
+        std::array<int, 5> buffer;
+        std::vector<int> values;
+        for (auto batch = gen.next_batch(buffer); !batch.empty(); batch = gen.next_batch(buffer))
+            values.insert(values.end(), batch.begin(), batch.end());
+
+        CHECK(values == std::vector{0, 1, 2, 3, 4, 5, 6});
+    }
+}
+
+TEST_CASE("Generator - next_batch - benchmark", "[.][benchmark]")
+{
+    constexpr size_t count = 1'000'000;
+
+    BENCHMARK("plain loop")
+    {
+        uint64_t a = 0, b = 1, sum = 0;
+        for (size_t i = 0; i < count; ++i)
+            sum += std::exchange(a, std::exchange(b, a + b));
+        return sum;
+    };
+
+    BENCHMARK("next_value() - per element")
+    {
+        uint64_t sum = 0;
+        auto gen = fibonacci_sequence(count);
+        while (auto item = gen.next_value())
+            sum += *item;
+        return sum;
+    };
+
+    BENCHMARK("next_batch() - batch of 256")
+    {
+        uint64_t sum = 0;
+        auto gen = fibonacci_sequence(count);
+        std::array<uint64_t, 256> buffer;
+        for (auto batch = gen.next_batch(buffer); !batch.empty(); batch = gen.next_batch(buffer))
+            for (uint64_t item : batch)
+                sum += item;
+        return sum;
+    };
+}
+
+////////////////////////////////////////////////////////////////////
+// async generator - co_await gen.next() with backpressure
+
+namespace Step_3
+{
+    // Producer may co_await other awaitables (e.g. schedule_on(pool)) between yields.
+    // Yielded values go to a bounded buffer: the producer runs until the buffer is full (backpressure)
+    // or a waiting consumer can be handed a value; the consumer resumes a suspended producer
+    // only when the buffer is drained.
+    template <typename T, size_t BufferSize = 64>
+    class [[nodiscard]] AsyncGenerator
+    {
+        static_assert(BufferSize > 0);
+
+    public:
+        struct promise_type;
+
+        using CoroutineHandle = std::coroutine_handle<promise_type>;
+
+        struct promise_type : FutureStd::Detail::PooledFrame
+        {
+            AsyncGenerator get_return_object()
+            {
+                return AsyncGenerator{CoroutineHandle::from_promise(*this)};
+            }
+
+            std::suspend_always initial_suspend() noexcept
+            {
+                suspended_producer_ = CoroutineHandle::from_promise(*this); // started by the first next()
+                return {};
+            }
+
+            auto final_suspend() noexcept
+            {
+                struct FinalAwaiter : std::suspend_always
+                {
+                    std::coroutine_handle<> await_suspend(CoroutineHandle producer) noexcept
+                    {
+                        promise_type& promise = producer.promise();
+
+                        std::unique_lock lk{promise.mtx_};
+                        promise.is_done_ = true;
+
+                        if (promise.is_abandoned_)
+                        {
+                            lk.unlock();
+                            producer.destroy();
+                            return std::noop_coroutine();
+                        }
+
+                        auto consumer = std::exchange(promise.waiting_consumer_, nullptr);
+                        return consumer ? consumer : std::noop_coroutine();
+                    }
+                };
+
+                return FinalAwaiter{};
+            }
+
+            void unhandled_exception() noexcept
+            {
+                exception_ = std::current_exception();
+            }
+
+            void return_void() noexcept
+            { }
+
+            template <typename U = T>
+                requires std::constructible_from<T, U&&>
+            auto yield_value(U&& value)
+            {
+                struct YieldAwaiter : std::suspend_always
+                {
+                    T value_;
+
+                    std::coroutine_handle<> await_suspend(CoroutineHandle producer)
+                    {
+                        promise_type& promise = producer.promise();
+
+                        std::unique_lock lk{promise.mtx_};
+
+                        if (promise.is_abandoned_)
+                        {
+                            lk.unlock();
+                            producer.destroy();
+                            return std::noop_coroutine();
+                        }
+
+                        promise.buffer_.push_back(std::move(value_));
+
+                        auto consumer = std::exchange(promise.waiting_consumer_, nullptr);
+                        if (!consumer && promise.buffer_.size() < BufferSize)
+                            return producer; // keep producing
+
+                        promise.suspended_producer_ = producer;
+                        return consumer ? consumer : std::noop_coroutine();
+                    }
+                };
+
+                return YieldAwaiter{{}, T(std::forward<U>(value))};
+            }
+
+        private:
+            friend class AsyncGenerator;
+
+            std::mutex mtx_;
+            std::deque<T> buffer_;
+            std::coroutine_handle<> suspended_producer_ = nullptr;
+            std::coroutine_handle<> waiting_consumer_ = nullptr;
+            std::exception_ptr exception_;
+            bool is_done_ = false;
+            bool is_abandoned_ = false;
+
+            bool try_pop(std::optional<T>& result)
+            {
+                if (buffer_.empty())
+                    return false;
+
+                result.emplace(std::move(buffer_.front()));
+                buffer_.pop_front();
+                return true;
+            }
+        };
+
+        class NextAwaiter
+        {
+            promise_type& promise_;
+            std::optional<T> result_;
+
+        public:
+            explicit NextAwaiter(promise_type& promise)
+                : promise_{promise}
+            { }
+
+            bool await_ready()
+            {
+                std::lock_guard lk{promise_.mtx_};
+                return promise_.try_pop(result_) || promise_.is_done_;
+            }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> consumer)
+            {
+                std::lock_guard lk{promise_.mtx_};
+
+                if (promise_.try_pop(result_) || promise_.is_done_)
+                    return consumer;
+
+                promise_.waiting_consumer_ = consumer;
+
+                // buffer is drained - suspended producer continues on the consumer's thread
+                auto producer = std::exchange(promise_.suspended_producer_, nullptr);
+                return producer ? producer : std::noop_coroutine();
+            }
+
+            std::optional<T> await_resume()
+            {
+                if (!result_)
+                {
+                    std::lock_guard lk{promise_.mtx_};
+                    if (!promise_.try_pop(result_) && promise_.exception_)
+                        std::rethrow_exception(promise_.exception_);
+                }
+
+                return std::move(result_);
+            }
+        };
+
+        explicit AsyncGenerator(CoroutineHandle coroutine_hndl)
+            : coroutine_hndl_{coroutine_hndl}
+        { }
+
+        AsyncGenerator(const AsyncGenerator&) = delete;
+        AsyncGenerator& operator=(const AsyncGenerator&) = delete;
+
+        AsyncGenerator(AsyncGenerator&& other) noexcept
+            : coroutine_hndl_{std::exchange(other.coroutine_hndl_, nullptr)}
+        { }
+
+        AsyncGenerator& operator=(AsyncGenerator&&) = delete;
+
+        // producer still running on another thread destroys itself at its next suspension point
+        ~AsyncGenerator()
+        {
+            if (!coroutine_hndl_)
+                return;
+
+            promise_type& promise = coroutine_hndl_.promise();
+            {
+                std::lock_guard lk{promise.mtx_};
+                if (!promise.is_done_ && !promise.suspended_producer_)
+                {
+                    promise.is_abandoned_ = true;
+                    return;
+                }
+            }
+
+            coroutine_hndl_.destroy();
+        }
+
+        // co_await gen.next() - std::nullopt when the producer is done
+        NextAwaiter next()
+        {
+            assert(coroutine_hndl_);
+            return NextAwaiter{coroutine_hndl_.promise()};
+        }
+
+    private:
+        CoroutineHandle coroutine_hndl_;
+    };
+} // namespace Step_3
+
+namespace Step_3
+{
+    using Step_2::Task;
+
+    AsyncGenerator<int, 8> numbers(int count, std::atomic<int>* no_of_produced = nullptr)
+    {
+        for (int i = 1; i <= count; ++i)
+        {
+            if (no_of_produced)
+                ++*no_of_produced;
+            co_yield i;
+        }
+    }
+
+    // stage of a pipeline - transforms values produced by a source on a new thread
+    template <typename T, size_t N>
+    AsyncGenerator<std::string> to_strings(AsyncGenerator<T, N> source)
+    {
+        co_await resume_on_new_thread();
+
+        while (auto value = co_await source.next())
+            co_yield std::to_string(*value);
+    }
+
+    AsyncGenerator<int> failing(int count)
+    {
+        for (int i = 0; i < count; ++i)
+            co_yield i;
+
+        throw std::runtime_error("Producer failed");
+    }
+
+    template <typename T, size_t N>
+    Task<std::vector<T>> collect(AsyncGenerator<T, N> source)
+    {
+        std::vector<T> result;
+        while (auto value = co_await source.next())
+            result.push_back(std::move(*value));
+        co_return result;
+    }
+} // namespace Step_3
+
+TEST_CASE("AsyncGenerator")
+{
+    using namespace Step_3;
+
+    SECTION("values are passed to the consumer")
+    {
+        auto values = Step_2::sync_wait(collect(numbers(100)));
+
+        CHECK(std::ranges::equal(values, std::views::iota(1, 101)));
+    }
+
+    SECTION("slow consumer applies backpressure")
+    {
+        std::atomic<int> no_of_produced{0};
+        int max_no_of_buffered = 0;
+
+        auto consumer = [&](AsyncGenerator<int, 8> source) -> Task<int> {
+            int no_of_consumed = 0;
+            while (auto value = co_await source.next())
+            {
+                ++no_of_consumed;
+                max_no_of_buffered = std::max(max_no_of_buffered, no_of_produced - no_of_consumed);
+            }
+            co_return no_of_consumed;
+        };
+
+        CHECK(Step_2::sync_wait(consumer(numbers(1000, &no_of_produced))) == 1000);
+        CHECK(max_no_of_buffered <= 8);
+    }
+
+    SECTION("pipeline with a stage on another thread")
+    {
+        auto values = Step_2::sync_wait(collect(to_strings(numbers(100))));
+
+        REQUIRE(values.size() == 100);
+        CHECK(values.front() == "1");
+        CHECK(values.back() == "100");
+    }
+
+    SECTION("exception is passed to the consumer after buffered values")
+    {
+        auto consumer = [](AsyncGenerator<int> source, std::vector<int>& values) -> Task<> {
+            while (auto value = co_await source.next())
+                values.push_back(*value);
+        };
+
+        std::vector<int> values;
+        CHECK_THROWS_AS(Step_2::sync_wait(consumer(failing(3), values)), std::runtime_error);
+        CHECK(values == std::vector{0, 1, 2});
+    }
+
+    SECTION("consumer may stop early")
+    {
+        auto consumer = [](AsyncGenerator<int, 8> source) -> Task<int> {
+            co_return *co_await source.next();
+        };
+
+        CHECK(Step_2::sync_wait(consumer(numbers(100))) == 1);
+    }
+}
+
+namespace Step_3
+{
+    AsyncGenerator<uint64_t, 256> produce_on(Concurrency::ThreadPool& pool, size_t count)
+    {
+        co_await schedule_on(pool);
+
+        for (uint64_t i = 0; i < count; ++i)
+            co_yield i;
+    }
+
+    template <size_t N>
+    AsyncGenerator<uint64_t, 256> square_on(Concurrency::ThreadPool& pool, AsyncGenerator<uint64_t, N> source)
+    {
+        co_await schedule_on(pool);
+
+        while (auto value = co_await source.next())
+            co_yield *value * *value;
+    }
+
+    template <size_t N>
+    Task<uint64_t> sum_of(AsyncGenerator<uint64_t, N> source)
+    {
+        uint64_t sum = 0;
+        while (auto value = co_await source.next())
+            sum += *value;
+        co_return sum;
+    }
+} // namespace Step_3
+
+TEST_CASE("AsyncGenerator - pipeline throughput", "[.][benchmark]")
+{
+    using namespace Step_3;
+
+    constexpr size_t count = 1'000'000;
+
+    Concurrency::ThreadPool pool{4};
+
+    BENCHMARK("3-stage pipeline (produce -> square -> sum) - 1M items")
+    {
+        return Step_2::sync_wait(sum_of(square_on(pool, produce_on(pool, count))));
+    };
+}
+
+////////////////////////////////////////////////////////////////////
+// structured concurrency - when_all & when_any
+
+namespace Step_4
+{
+    using Step_2::Task;
+
+    template <typename T>
+    using NonVoid = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+    template <typename TTask>
+    struct TaskTraits;
+
+    template <typename T>
+    struct TaskTraits<Task<T>>
+    {
+        using result_type = T;
+    };
+
+    // lock-free join: parent & every child decrement the counter - the last one resumes the parent
+    class JoinCounter
+    {
+        std::atomic<size_t> count_;
+        std::coroutine_handle<> awaiting_ = nullptr;
+
+    public:
+        explicit JoinCounter(size_t no_of_children)
+            : count_{no_of_children + 1}
+        { }
+
+        std::coroutine_handle<> arrive() noexcept
+        {
+            if (count_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                return awaiting_;
+            return std::noop_coroutine();
+        }
+
+        // starts the children & suspends the awaiting coroutine until all of them arrive
+        template <std::invocable TStartChildren>
+        auto join(TStartChildren start_children)
+        {
+            struct JoinAwaiter : std::suspend_always
+            {
+                JoinCounter& counter_;
+                TStartChildren start_children_;
+
+                bool await_suspend(std::coroutine_handle<> awaiting) noexcept
+                {
+                    counter_.awaiting_ = awaiting;
+                    start_children_();
+                    return counter_.count_.fetch_sub(1, std::memory_order_acq_rel) > 1;
+                }
+            };
+
+            return JoinAwaiter{{}, *this, std::move(start_children)};
+        }
+    };
+
+    // child coroutine - destroys itself & arrives at the counter when completed
+    struct JoinChild
+    {
+        struct promise_type
+        {
+            JoinCounter& counter_;
+
+            promise_type(JoinCounter& counter, auto&...) noexcept
+                : counter_{counter}
+            { }
+
+            JoinChild get_return_object() noexcept { return {}; }
+
+            std::suspend_never initial_suspend() const noexcept { return {}; }
+
+            auto final_suspend() const noexcept
+            {
+                struct FinalAwaiter : std::suspend_always
+                {
+                    std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> child) noexcept
+                    {
+                        JoinCounter& counter = child.promise().counter_;
+                        child.destroy();
+                        return counter.arrive();
+                    }
+                };
+
+                return FinalAwaiter{};
+            }
+
+            void unhandled_exception() noexcept { std::terminate(); } // child bodies catch all exceptions
+
+            void return_void() noexcept { }
+        };
+    };
+
+    // counter is used only by the promise; the task's result is converted to TResult when stored
+    template <typename T, typename TResult, typename TExecutor, typename TOnSuccess>
+    JoinChild run_child([[maybe_unused]] JoinCounter& counter, TExecutor& executor, std::stop_token stop_token, Task<T> task,
+        std::optional<TResult>& result, std::exception_ptr& exception, TOnSuccess on_success)
+    {
+        co_await schedule_on(executor);
+
+        if (stop_token.stop_requested()) // cancelled before it was started
+            co_return;
+
+        try
+        {
+            if constexpr (std::is_void_v<T>)
+            {
+                co_await task;
+                result.emplace();
+            }
+            else
+                result.emplace(co_await task);
+
+            on_success();
+        }
+        catch (...)
+        {
+            exception = std::current_exception();
+        }
+    }
+
+    // runs tasks concurrently on the executor - results are returned in order of arguments,
+    // the first exception (in order of arguments) is rethrown after all children completed
+    template <Executor TExecutor, typename... Ts>
+    Task<std::tuple<NonVoid<Ts>...>> when_all(TExecutor& executor, Task<Ts>... tasks)
+    {
+        std::tuple<std::optional<NonVoid<Ts>>...> results;
+        std::array<std::exception_ptr, sizeof...(Ts)> exceptions;
+        JoinCounter counter{sizeof...(Ts)};
+
+        auto start_children = [&]<size_t... Is>(std::index_sequence<Is...>) {
+            (run_child(counter, executor, std::stop_token{}, std::move(tasks), std::get<Is>(results), exceptions[Is], [] {}), ...);
+        };
+
+        co_await counter.join([&] { start_children(std::index_sequence_for<Ts...>{}); });
+
+        for (const auto& exception : exceptions)
+            if (exception)
+                std::rethrow_exception(exception);
+
+        co_return std::apply([](auto&... result) { return std::tuple<NonVoid<Ts>...>{std::move(*result)...}; }, results);
+    }
+
+    template <typename... TTaskFactories>
+    using WhenAnyResult = std::common_type_t<NonVoid<typename TaskTraits<std::invoke_result_t<TTaskFactories&, std::stop_token>>::result_type>...>;
+
+    // tasks are created by factories taking a std::stop_token - first successful result
+    // (converted to the common type of the results) wins, remaining children are cancelled & joined
+    // before when_any completes
+    template <Executor TExecutor, typename... TTaskFactories>
+        requires(sizeof...(TTaskFactories) > 0) && (std::invocable<TTaskFactories&, std::stop_token> && ...)
+    Task<std::pair<size_t, WhenAnyResult<TTaskFactories...>>> when_any(TExecutor& executor, TTaskFactories... factories)
+    {
+        using T = WhenAnyResult<TTaskFactories...>;
+        constexpr size_t no_of_children = sizeof...(TTaskFactories);
+
+        std::stop_source stop_source;
+        std::atomic<size_t> winner{no_of_children};
+        std::array<std::optional<T>, no_of_children> results;
+        std::array<std::exception_ptr, no_of_children> exceptions;
+        JoinCounter counter{no_of_children};
+
+        auto claim_victory = [&](size_t index) {
+            size_t no_winner = no_of_children;
+            if (winner.compare_exchange_strong(no_winner, index, std::memory_order_acq_rel))
+                stop_source.request_stop();
+        };
+
+        auto start_children = [&]<size_t... Is>(std::index_sequence<Is...>) {
+            (run_child(counter, executor, stop_source.get_token(), factories(stop_source.get_token()),
+                 results[Is], exceptions[Is], [&claim_victory] { claim_victory(Is); }),
+                ...);
+        };
+
+        co_await counter.join([&] { start_children(std::index_sequence_for<TTaskFactories...>{}); });
+
+        const size_t index = winner.load(std::memory_order_acquire);
+
+        if (index == no_of_children)
+        {
+            for (const auto& exception : exceptions)
+                if (exception)
+                    std::rethrow_exception(exception);
+        }
+
+        co_return std::pair{index, std::move(*results[index])};
+    }
+} // namespace Step_4
+
+namespace Step_4
+{
+    using namespace std::chrono;
+
+    // simulated remote lookup - polls the stop token while waiting for the response
+    Task<int> lookup(std::stop_token stop_token, int key, microseconds latency)
+    {
+        const auto deadline = steady_clock::now() + latency;
+
+        while (steady_clock::now() < deadline)
+        {
+            if (stop_token.stop_requested())
+                throw std::runtime_error("Lookup cancelled");
+
+            std::this_thread::sleep_for(std::min<steady_clock::duration>(100us, deadline - steady_clock::now()));
+        }
+
+        co_return key * 10;
+    }
+
+    Task<int> failing_lookup(std::stop_token, int key)
+    {
+        throw std::runtime_error("Lookup#" + std::to_string(key) + " failed");
+        co_return 0;
+    }
+} // namespace Step_4
+
+TEST_CASE("when_all")
+{
+    using namespace Step_4;
+
+    Concurrency::ThreadPool pool{4};
+
+    SECTION("results are returned in order of arguments")
+    {
+        auto [a, b, c] = Step_2::sync_wait(when_all(pool, lookup({}, 1, 3ms), lookup({}, 2, 1ms), Step_2::answer()));
+
+        CHECK(a == 10);
+        CHECK(b == 20);
+        CHECK(c == 42);
+    }
+
+    SECTION("children run concurrently")
+    {
+        std::latch all_started{4};
+
+        auto child = [&all_started]() -> Task<> {
+            all_started.arrive_and_wait(); // blocks forever unless all 4 children run at the same time
+            co_return;
+        };
+
+        auto results = Step_2::sync_wait(when_all(pool, child(), child(), child(), child()));
+        static_assert(std::is_same_v<decltype(results), std::tuple<std::monostate, std::monostate, std::monostate, std::monostate>>);
+    }
+
+    SECTION("exception is rethrown after all children completed")
+    {
+        CHECK_THROWS_AS(Step_2::sync_wait(when_all(pool, lookup({}, 1, 1ms), failing_lookup({}, 2))), std::runtime_error);
+    }
+
+    SECTION("no children")
+    {
+        CHECK(Step_2::sync_wait(when_all(pool)) == std::tuple{});
+    }
+}
+
+TEST_CASE("when_any")
+{
+    using namespace Step_4;
+
+    Concurrency::ThreadPool pool{4};
+
+    SECTION("first result wins & the losers are cancelled")
+    {
+        std::stop_token children_stop_token;
+
+        // a slow child may be cancelled before it was started - its body never runs then
+        auto slow = [&children_stop_token](std::stop_token stop_token) {
+            children_stop_token = stop_token;
+            return lookup(stop_token, 1, 10s);
+        };
+
+        const auto start = steady_clock::now();
+        auto [index, value] = Step_2::sync_wait(when_any(pool, slow, [](std::stop_token st) { return lookup(st, 2, 1ms); }, slow));
+
+        CHECK(index == 1);
+        CHECK(value == 20);
+        CHECK(children_stop_token.stop_requested());
+        CHECK(steady_clock::now() - start < 5s);
+    }
+
+    SECTION("failed children do not win")
+    {
+        auto [index, value] = Step_2::sync_wait(when_any(pool,
+            [](std::stop_token st) { return failing_lookup(st, 1); },
+            [](std::stop_token st) { return lookup(st, 2, 5ms); }));
+
+        CHECK(index == 1);
+        CHECK(value == 20);
+    }
+
+    SECTION("results are converted to their common type")
+    {
+        auto [index, value] = Step_2::sync_wait(when_any(pool,
+            [](std::stop_token st) { return lookup(st, 1, 10s); },
+            [](std::stop_token) -> Task<double> { co_return 0.5; }));
+
+        static_assert(std::is_same_v<decltype(value), double>);
+        CHECK(index == 1);
+        CHECK(value == 0.5);
+    }
+
+    SECTION("exception is rethrown when all children failed")
+    {
+        CHECK_THROWS_AS(Step_2::sync_wait(when_any(pool,
+                            [](std::stop_token st) { return failing_lookup(st, 1); },
+                            [](std::stop_token st) { return failing_lookup(st, 2); })),
+            std::runtime_error);
+    }
+}
+
+TEST_CASE("when_all & when_any - latency distribution", "[.][benchmark]")
+{
+    using namespace Step_4;
+
+    constexpr int no_of_requests = 200;
+    constexpr int fan_out = 8;
+
+    Concurrency::ThreadPool pool{2 * fan_out};
+
+    // 95% of lookups take 1ms, 5% hit the 20ms tail
+    std::mt19937 rnd_gen{665};
+    std::bernoulli_distribution is_slow{0.05};
+    auto next_latency = [&] { return is_slow(rnd_gen) ? microseconds{20ms} : microseconds{1ms}; };
+
+    auto report = [](std::string_view name, std::vector<double> latencies_ms) {
+        std::ranges::sort(latencies_ms);
+        auto percentile = [&](double p) { return latencies_ms[static_cast<size_t>(p * (latencies_ms.size() - 1))]; };
+        std::cout << name << " - p50: " << percentile(0.5) << "ms, p90: " << percentile(0.9)
+                  << "ms, p99: " << percentile(0.99) << "ms, max: " << latencies_ms.back() << "ms\n";
+    };
+
+    auto measure = [](auto request) {
+        const auto start = steady_clock::now();
+        request();
+        return duration<double, std::milli>(steady_clock::now() - start).count();
+    };
+
+    std::vector<double> sequential, fanned_out, single, hedged;
+
+    for (int r = 0; r < no_of_requests; ++r)
+    {
+        std::array<microseconds, fan_out> latencies;
+        std::ranges::generate(latencies, next_latency);
+
+        sequential.push_back(measure([&] {
+            for (int i = 0; i < fan_out; ++i)
+                Step_2::sync_wait(lookup({}, i, latencies[i]));
+        }));
+
+        fanned_out.push_back(measure([&] {
+            auto start_lookups = [&]<size_t... Is>(std::index_sequence<Is...>) {
+                return when_all(pool, lookup({}, Is, latencies[Is])...);
+            };
+            Step_2::sync_wait(start_lookups(std::make_index_sequence<fan_out>{}));
+        }));
+
+        const auto primary = next_latency(), replica = next_latency();
+
+        single.push_back(measure([&] { Step_2::sync_wait(lookup({}, 1, primary)); }));
+
+        hedged.push_back(measure([&] {
+            Step_2::sync_wait(when_any(pool,
+                [primary](std::stop_token st) { return lookup(st, 1, primary); },
+                [replica](std::stop_token st) { return lookup(st, 1, replica); }));
+        }));
+    }
+
+    report("8 lookups - sequential", sequential);
+    report("8 lookups - when_all", fanned_out);
+    report("1 lookup - single replica", single);
+    report("1 lookup - when_any of 2 replicas", hedged);
+}
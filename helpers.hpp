@@ -6,6 +6,24 @@
 #include <random>
 #include <ranges>
 #include <algorithm>
+#include <charconv>
+#include <concepts>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#if __has_include(<sys/mman.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#define HELPERS_HAS_MMAP 1
+#else
+#define HELPERS_HAS_MMAP 0
+#endif
 
 namespace Helpers
 {
@@ -13,9 +31,60 @@ namespace Helpers
     concept PrintableRange = std::ranges::range<T>
         && requires { std::cout << std::declval<std::ranges::range_value_t<T>>(); };
 
+    namespace Detail
+    {
+        // numbers that operator<< prints exactly like std::to_chars (chars & bools are printed differently)
+        template <typename T>
+        concept ToCharsPrintable = std::floating_point<T>
+            || (std::integral<T> && !std::same_as<T, bool> && !std::same_as<T, char> && !std::same_as<T, signed char>
+                && !std::same_as<T, unsigned char> && !std::same_as<T, wchar_t> && !std::same_as<T, char8_t>
+                && !std::same_as<T, char16_t> && !std::same_as<T, char32_t>);
+
+        inline bool has_default_format(const std::ostream& out)
+        {
+            return out.flags() == (std::ios_base::skipws | std::ios_base::dec) && out.precision() == 6 && out.width() == 0;
+        }
+
+        // formats into a local buffer with std::to_chars & writes it out in large blocks
+        void print_buffered(std::ostream& out, auto&& rng)
+        {
+            constexpr size_t buffer_size = 64 * 1024;
+            constexpr size_t max_item_size = 64;
+            char buffer[buffer_size];
+            char* pos = buffer;
+
+            for (const auto& item : rng)
+            {
+                if (buffer + buffer_size - pos < static_cast<std::ptrdiff_t>(max_item_size))
+                {
+                    out.write(buffer, pos - buffer);
+                    pos = buffer;
+                }
+
+                if constexpr (std::floating_point<std::remove_cvref_t<decltype(item)>>)
+                    pos = std::to_chars(pos, buffer + buffer_size, item, std::chars_format::general, 6).ptr; // like operator<<
+                else
+                    pos = std::to_chars(pos, buffer + buffer_size, item).ptr;
+                *pos++ = ' ';
+            }
+
+            out.write(buffer, pos - buffer);
+        }
+    } // namespace Detail
+
     void print(PrintableRange auto&& rng, std::string_view prefix = "items")
     {
         std::cout << prefix << ": [ ";
+        if constexpr (Detail::ToCharsPrintable<std::remove_cvref_t<std::ranges::range_reference_t<decltype(rng)>>>)
+        {
+            if (Detail::has_default_format(std::cout))
+            {
+                Detail::print_buffered(std::cout, rng);
+                std::cout << "]\n";
+                return;
+            }
+        }
+
         for (const auto& item : rng)
             std::cout << item << " ";
         std::cout << "]\n";
@@ -32,6 +101,101 @@ namespace Helpers
 
         return data;
     }
+
+    //////////////////////////////////////////////////////////////////////
+    // Parallel, deterministic datasets
+    //  - counter-based RNG: item i is splitmix64(seed, i) mapped onto [low, high],
+    //    so chunks can be filled on any number of threads with identical output for a given seed
+    //  - the mapping is multiply-shift on 32 random bits: bias below (high - low + 1) / 2^32
+
+    struct DatasetOptions
+    {
+        uint64_t seed = 42;
+        unsigned no_of_threads = std::max(1u, std::thread::hardware_concurrency());
+    };
+
+    constexpr uint64_t splitmix64(uint64_t seed, uint64_t counter) noexcept
+    {
+        uint64_t z = seed + (counter + 1) * 0x9E3779B97F4A7C15ULL;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    // fills data[i] with the items first_index + i of the dataset
+    inline void fill_numeric_dataset(std::span<int> data, int low, int high, const DatasetOptions& options, uint64_t first_index = 0)
+    {
+        const uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(high) - low) + 1;
+
+        auto fill_chunk = [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+            {
+                const uint64_t random_bits = splitmix64(options.seed, first_index + i) >> 32;
+                data[i] = static_cast<int>(low + static_cast<int64_t>((random_bits * range) >> 32));
+            }
+        };
+
+        constexpr size_t min_chunk_size = 64 * 1024;
+        const size_t no_of_chunks = std::clamp<size_t>(data.size() / min_chunk_size, 1, std::max(1u, options.no_of_threads));
+
+        std::vector<std::jthread> threads;
+        threads.reserve(no_of_chunks - 1);
+        for (size_t chunk = 1; chunk < no_of_chunks; ++chunk)
+            threads.emplace_back(fill_chunk, data.size() * chunk / no_of_chunks, data.size() * (chunk + 1) / no_of_chunks);
+        fill_chunk(0, data.size() / no_of_chunks);
+    }
+
+    inline std::vector<int> create_numeric_dataset(size_t size, int low, int high, const DatasetOptions& options)
+    {
+        std::vector<int> data(size);
+        fill_numeric_dataset(data, low, high, options);
+        return data;
+    }
+
+    // writes the dataset as raw ints straight into a memory-mapped file
+    inline void create_numeric_dataset_file(const std::filesystem::path& path, size_t size, int low, int high, const DatasetOptions& options = {})
+    {
+        const size_t size_in_bytes = size * sizeof(int);
+
+#if HELPERS_HAS_MMAP
+        const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd == -1)
+            throw std::system_error(errno, std::generic_category(), "cannot create " + path.string());
+
+        if (::ftruncate(fd, static_cast<off_t>(size_in_bytes)) == -1)
+        {
+            const int error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), "cannot resize " + path.string());
+        }
+
+        if (size_in_bytes == 0)
+        {
+            ::close(fd);
+            return;
+        }
+
+        void* mapping = ::mmap(nullptr, size_in_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        const int error = errno;
+        ::close(fd);
+        if (mapping == MAP_FAILED)
+            throw std::system_error(error, std::generic_category(), "cannot map " + path.string());
+
+        fill_numeric_dataset(std::span{static_cast<int*>(mapping), size}, low, high, options);
+        ::munmap(mapping, size_in_bytes);
+#else
+        std::ofstream out{path, std::ios::binary};
+        std::vector<int> buffer(std::min<size_t>(size, 1 << 20));
+        for (size_t written = 0; written < size; written += buffer.size())
+        {
+            const size_t chunk_size = std::min(buffer.size(), size - written);
+            fill_numeric_dataset(std::span{buffer}.first(chunk_size), low, high, options, written);
+            out.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(chunk_size * sizeof(int)));
+        }
+        if (!out)
+            throw std::system_error(std::make_error_code(std::errc::io_error), "cannot write " + path.string());
+#endif
+    }
 } // namespace Helpers
 
 #endif // HELPERS_HPP
\ No newline at end of file
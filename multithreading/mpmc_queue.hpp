@@ -0,0 +1,152 @@
+#ifndef MPMC_QUEUE_HPP
+#define MPMC_QUEUE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace Concurrency
+{
+    inline constexpr size_t cache_line_size = 64;
+
+    ///////////////////////////////////////////////////////////////////////
+    // Bounded lock-free multi-producer/multi-consumer queue (D. Vyukov's algorithm)
+    //  - ring buffer of cache-line aligned slots; each slot carries a sequence number
+    //    telling producers & consumers whose turn it is to use it
+    //  - capacity is rounded up to a power of 2
+
+    template <typename T>
+    class MpmcQueue
+    {
+    public:
+        using value_type = T;
+
+        explicit MpmcQueue(size_t capacity)
+            : mask_{std::bit_ceil(std::max<size_t>(capacity, 2)) - 1}
+            , slots_{std::make_unique<Slot[]>(mask_ + 1)}
+        {
+            for (size_t i = 0; i <= mask_; ++i)
+                slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        MpmcQueue(const MpmcQueue&) = delete;
+        MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+        ~MpmcQueue()
+        {
+            while (try_pop())
+                ;
+        }
+
+        size_t capacity() const noexcept
+        {
+            return mask_ + 1;
+        }
+
+        template <typename... TArgs>
+        bool try_emplace(TArgs&&... args)
+        {
+            size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+            Slot* slot;
+
+            while (true)
+            {
+                slot = &slots_[pos & mask_];
+                const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+                const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+
+                if (diff == 0)
+                {
+                    if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        break;
+                }
+                else if (diff < 0)
+                    return false; // full
+                else
+                    pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+
+            ::new (slot->storage) T(std::forward<TArgs>(args)...);
+            slot->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool try_push(const T& value)
+        {
+            return try_emplace(value);
+        }
+
+        bool try_push(T&& value)
+        {
+            return try_emplace(std::move(value));
+        }
+
+        std::optional<T> try_pop()
+        {
+            size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+            Slot* slot;
+
+            while (true)
+            {
+                slot = &slots_[pos & mask_];
+                const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+                const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1);
+
+                if (diff == 0)
+                {
+                    if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        break;
+                }
+                else if (diff < 0)
+                    return std::nullopt; // empty
+                else
+                    pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+
+            T* item = std::launder(reinterpret_cast<T*>(slot->storage));
+            std::optional<T> result{std::move(*item)};
+            item->~T();
+
+            slot->sequence.store(pos + mask_ + 1, std::memory_order_release);
+            return result;
+        }
+
+        // blocking versions - spin (yielding the time slice) while the queue is full/empty
+        void push(T value)
+        {
+            while (!try_push(std::move(value)))
+                std::this_thread::yield();
+        }
+
+        T pop()
+        {
+            while (true)
+            {
+                if (auto item = try_pop())
+                    return std::move(*item);
+                std::this_thread::yield();
+            }
+        }
+
+    private:
+        struct alignas(cache_line_size) Slot
+        {
+            std::atomic<size_t> sequence;
+            alignas(T) std::byte storage[sizeof(T)];
+        };
+
+        const size_t mask_;
+        const std::unique_ptr<Slot[]> slots_;
+        alignas(cache_line_size) std::atomic<size_t> enqueue_pos_{0};
+        alignas(cache_line_size) std::atomic<size_t> dequeue_pos_{0};
+    };
+} // namespace Concurrency
+
+#endif // MPMC_QUEUE_HPP
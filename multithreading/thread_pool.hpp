@@ -0,0 +1,218 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <stop_token>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Concurrency
+{
+    ///////////////////////////////////////////////////////////////////////
+    // Fixed-size work-stealing thread pool
+    //  - every worker owns a deque: the owner pushes & pops at the back (LIFO),
+    //    thieves steal from the front (FIFO) of a randomly chosen victim
+    //  - tasks submitted from outside the pool are distributed round-robin
+    //  - cancellation: like std::jthread, a task whose first parameter is std::stop_token
+    //    receives the pool's token; destroying the pool requests stop and drops queued tasks
+    //  - an exception thrown by a task is passed to the error handler (by default it is ignored) -
+    //    the worker continues with the next task
+    //  - a pool has at least one worker (size 0 is treated as 1)
+
+    class ThreadPool
+    {
+    public:
+        using Task = std::function<void()>;
+        using ErrorHandler = std::function<void(std::exception_ptr)>; // called on the worker's thread
+
+        explicit ThreadPool(size_t size = std::max(1u, std::thread::hardware_concurrency()), ErrorHandler on_error = {})
+            : queues_(std::max<size_t>(size, 1))
+            , on_error_{std::move(on_error)}
+        {
+            for (auto& q : queues_)
+                q = std::make_unique<WorkQueue>();
+
+            workers_.reserve(queues_.size());
+            for (size_t index = 0; index < queues_.size(); ++index)
+                workers_.emplace_back([this, index] { run(index); });
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        ~ThreadPool()
+        {
+            request_stop();
+            workers_.clear(); // joins workers
+        }
+
+        template <typename F, typename... TArgs>
+        void submit(F&& f, TArgs&&... args)
+        {
+            if constexpr (std::is_invocable_v<std::decay_t<F>&, std::stop_token, std::decay_t<TArgs>&...>)
+            {
+                push([this, f = std::forward<F>(f), ... args = std::forward<TArgs>(args)]() mutable {
+                    std::invoke(f, stop_source_.get_token(), args...);
+                });
+            }
+            else
+            {
+                push([f = std::forward<F>(f), ... args = std::forward<TArgs>(args)]() mutable {
+                    std::invoke(f, args...);
+                });
+            }
+        }
+
+        bool request_stop() noexcept
+        {
+            bool result = stop_source_.request_stop();
+            {
+                std::lock_guard lk{idle_mtx_};
+            }
+            idle_cv_.notify_all();
+            return result;
+        }
+
+        std::stop_token get_stop_token() const noexcept
+        {
+            return stop_source_.get_token();
+        }
+
+        size_t size() const noexcept
+        {
+            return queues_.size();
+        }
+
+    private:
+        struct WorkQueue
+        {
+            std::mutex mtx;
+            std::deque<Task> tasks;
+
+            void push_back(Task task)
+            {
+                std::lock_guard lk{mtx};
+                tasks.push_back(std::move(task));
+            }
+
+            bool try_pop_back(Task& task)
+            {
+                std::lock_guard lk{mtx};
+                if (tasks.empty())
+                    return false;
+                task = std::move(tasks.back());
+                tasks.pop_back();
+                return true;
+            }
+
+            bool try_steal_front(Task& task)
+            {
+                std::unique_lock lk{mtx, std::try_to_lock};
+                if (!lk || tasks.empty())
+                    return false;
+                task = std::move(tasks.front());
+                tasks.pop_front();
+                return true;
+            }
+        };
+
+        // identifies the worker (if any) running on the current thread
+        static inline thread_local const ThreadPool* current_pool_ = nullptr;
+        static inline thread_local size_t current_index_ = 0;
+
+        std::vector<std::unique_ptr<WorkQueue>> queues_;
+        ErrorHandler on_error_;
+        std::stop_source stop_source_;
+        std::atomic<size_t> pending_{0};
+        std::atomic<size_t> sleeping_{0};
+        std::atomic<size_t> next_queue_{0};
+        std::mutex idle_mtx_;
+        std::condition_variable_any idle_cv_;
+        std::vector<std::jthread> workers_; // last member - started after the rest is ready
+
+        void push(Task task)
+        {
+            const size_t index = (current_pool_ == this)
+                ? current_index_
+                : next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+
+            pending_.fetch_add(1);
+            queues_[index]->push_back(std::move(task));
+
+            if (sleeping_.load() > 0)
+            {
+                {
+                    std::lock_guard lk{idle_mtx_}; // worker is either before its predicate check or waiting
+                }
+                idle_cv_.notify_one();
+            }
+        }
+
+        bool try_pop(size_t index, Task& task, std::minstd_rand& rnd_gen)
+        {
+            if (queues_[index]->try_pop_back(task))
+                return true;
+
+            const size_t size = queues_.size();
+            const size_t first_victim = rnd_gen() % size;
+            for (size_t i = 0; i < size; ++i)
+            {
+                const size_t victim = (first_victim + i) % size;
+                if (victim != index && queues_[victim]->try_steal_front(task))
+                    return true;
+            }
+
+            return false;
+        }
+
+        void execute(Task& task) noexcept
+        {
+            try
+            {
+                task();
+            }
+            catch (...)
+            {
+                if (on_error_)
+                    on_error_(std::current_exception()); // an exception from the handler terminates - like from a std::jthread
+            }
+        }
+
+        void run(size_t index)
+        {
+            current_pool_ = this;
+            current_index_ = index;
+
+            std::minstd_rand rnd_gen(static_cast<std::minstd_rand::result_type>(index + 1));
+            std::stop_token stop_token = stop_source_.get_token();
+
+            while (!stop_token.stop_requested())
+            {
+                Task task;
+                if (try_pop(index, task, rnd_gen))
+                {
+                    pending_.fetch_sub(1);
+                    execute(task);
+                    continue;
+                }
+
+                std::unique_lock lk{idle_mtx_};
+                sleeping_.fetch_add(1);
+                idle_cv_.wait(lk, stop_token, [this] { return pending_.load() > 0; });
+                sleeping_.fetch_sub(1);
+            }
+        }
+    };
+} // namespace Concurrency
+
+#endif // THREAD_POOL_HPP
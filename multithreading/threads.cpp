@@ -1,6 +1,19 @@
+#include "mpmc_queue.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <numeric>
 #include <numbers>
+#include <stdexcept>
 #include <string>
 #include <thread>
 #include <vector>
@@ -44,3 +57,335 @@ TEST_CASE("jthread")
     //may_throw();
 }
 
+///////////////////////////////////////////////////////////////////////////
+// thread pool
+
+TEST_CASE("thread pool")
+{
+    Concurrency::ThreadPool pool{4};
+
+    SECTION("executes all submitted tasks")
+    {
+        constexpr int no_of_tasks = 10'000;
+
+        std::atomic<int> counter{0};
+        auto done = std::make_shared<std::latch>(no_of_tasks);
+
+        for (int i = 0; i < no_of_tasks; ++i)
+            pool.submit([&counter, done] { counter.fetch_add(1, std::memory_order_relaxed); done->count_down(); });
+
+        done->wait();
+        CHECK(counter == no_of_tasks);
+    }
+
+    SECTION("tasks submitted from a worker are executed")
+    {
+        auto done = std::make_shared<std::latch>(100);
+
+        pool.submit([&pool, done] {
+            for (int i = 0; i < 100; ++i)
+                pool.submit([done] { done->count_down(); });
+        });
+
+        done->wait();
+    }
+
+    SECTION("cancellation with std::stop_token")
+    {
+        std::latch all_ready{2};
+
+        pool.submit(background_work, 1, "THD#111111111111111", 50ms, std::ref(all_ready));
+        pool.submit(background_work, 2, "THD#222222222222222222", 10ms, std::ref(all_ready));
+
+        auto stopped = std::make_shared<std::latch>(1);
+        pool.submit([stopped](std::stop_token st) {
+            while (!st.stop_requested())
+                std::this_thread::yield();
+            stopped->count_down();
+        });
+
+        std::this_thread::sleep_for(200ms);
+
+        pool.request_stop();
+
+        stopped->wait();
+        CHECK(pool.get_stop_token().stop_requested());
+    }
+}
+
+TEST_CASE("thread pool - edge cases")
+{
+    SECTION("size 0 gives one worker")
+    {
+        Concurrency::ThreadPool pool{0};
+        CHECK(pool.size() == 1);
+
+        auto done = std::make_shared<std::latch>(10);
+        for (int i = 0; i < 10; ++i)
+            pool.submit([done] { done->count_down(); });
+        done->wait();
+    }
+
+    SECTION("exceptions from tasks are passed to the error handler & the workers continue")
+    {
+        std::mutex mtx;
+        std::vector<std::string> errors;
+        std::latch all_reported{2};
+
+        Concurrency::ThreadPool pool{2, [&](std::exception_ptr error) {
+            try
+            {
+                std::rethrow_exception(error);
+            }
+            catch (const std::exception& e)
+            {
+                std::lock_guard lk{mtx};
+                errors.push_back(e.what());
+            }
+            all_reported.count_down();
+        }};
+
+        for (int i = 0; i < 4; ++i)
+            pool.submit([i] {
+                if (i % 2 == 0)
+                    throw std::runtime_error("task#" + std::to_string(i) + " failed");
+            });
+
+        all_reported.wait();
+
+        auto done = std::make_shared<std::latch>(100);
+        for (int i = 0; i < 100; ++i)
+            pool.submit([done] { done->count_down(); });
+        done->wait();
+
+        std::lock_guard lk{mtx};
+        std::ranges::sort(errors);
+        CHECK(errors == std::vector<std::string>{"task#0 failed", "task#2 failed"});
+    }
+}
+
+TEST_CASE("thread pool vs. jthread per task", "[.][benchmark]")
+{
+    static constexpr int tasks_per_submitter = 256;
+
+    Concurrency::ThreadPool pool;
+
+    for (const int no_of_submitters : {1, 4, 16, 64})
+    {
+        const std::string suffix = std::to_string(no_of_submitters) + " submitters - "
+            + std::to_string(no_of_submitters * tasks_per_submitter) + " tasks";
+
+        BENCHMARK("jthread per task - " + suffix)
+        {
+            std::atomic<int> counter{0};
+            {
+                std::vector<std::jthread> submitters;
+                for (int s = 0; s < no_of_submitters; ++s)
+                    submitters.emplace_back([&counter] {
+                        std::vector<std::jthread> tasks;
+                        tasks.reserve(tasks_per_submitter);
+                        for (int t = 0; t < tasks_per_submitter; ++t)
+                            tasks.emplace_back([&counter] { counter.fetch_add(1, std::memory_order_relaxed); });
+                    });
+            }
+            return counter.load();
+        };
+
+        BENCHMARK("thread pool - " + suffix)
+        {
+            std::atomic<int> counter{0};
+            auto done = std::make_shared<std::latch>(no_of_submitters * tasks_per_submitter);
+            {
+                std::vector<std::jthread> submitters;
+                for (int s = 0; s < no_of_submitters; ++s)
+                    submitters.emplace_back([&pool, &counter, done] {
+                        for (int t = 0; t < tasks_per_submitter; ++t)
+                            pool.submit([&counter, done] { counter.fetch_add(1, std::memory_order_relaxed); done->count_down(); });
+                    });
+            }
+            done->wait();
+            return counter.load();
+        };
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////
+// lock-free MPMC queue
+
+TEST_CASE("MpmcQueue")
+{
+    SECTION("FIFO order & bounded capacity")
+    {
+        Concurrency::MpmcQueue<int> queue{3};
+        REQUIRE(queue.capacity() == 4);
+
+        for (int i = 1; i <= 4; ++i)
+            CHECK(queue.try_push(i));
+        CHECK_FALSE(queue.try_push(5)); // full
+
+        for (int i = 1; i <= 4; ++i)
+            CHECK(queue.try_pop() == i);
+        CHECK(queue.try_pop() == std::nullopt); // empty
+    }
+
+    SECTION("move-only items")
+    {
+        Concurrency::MpmcQueue<std::unique_ptr<std::string>> queue{8};
+
+        queue.push(std::make_unique<std::string>("text"));
+        CHECK(*queue.pop() == "text");
+
+        queue.push(std::make_unique<std::string>("left in queue")); // destroyed by the queue
+    }
+
+    SECTION("multiple producers & consumers")
+    {
+        constexpr int no_of_producers = 4;
+        constexpr int no_of_consumers = 4;
+        constexpr int items_per_producer = 100'000;
+
+        Concurrency::MpmcQueue<int> queue{1024};
+        std::atomic<long long> sum{0};
+        {
+            std::vector<std::jthread> threads;
+            for (int p = 0; p < no_of_producers; ++p)
+                threads.emplace_back([&queue] {
+                    for (int i = 1; i <= items_per_producer; ++i)
+                        queue.push(i);
+                });
+
+            for (int c = 0; c < no_of_consumers; ++c)
+                threads.emplace_back([&queue, &sum] {
+                    long long local_sum = 0;
+                    for (int i = 0; i < no_of_producers * items_per_producer / no_of_consumers; ++i)
+                        local_sum += queue.pop();
+                    sum += local_sum;
+                });
+        }
+
+        CHECK(sum == no_of_producers * (items_per_producer * (items_per_producer + 1LL) / 2));
+    }
+
+    SECTION("jthread workers consume work items")
+    {
+        Concurrency::MpmcQueue<std::function<void()>> work_queue{256};
+        std::atomic<int> counter{0};
+        std::latch done{1000};
+        {
+            std::vector<std::jthread> workers;
+            for (int w = 0; w < 4; ++w)
+                workers.emplace_back([&work_queue](std::stop_token st) {
+                    while (!st.stop_requested())
+                    {
+                        if (auto work = work_queue.try_pop())
+                            (*work)();
+                        else
+                            std::this_thread::yield();
+                    }
+                });
+
+            for (int i = 0; i < 1000; ++i)
+                work_queue.push([&] { ++counter; done.count_down(); });
+
+            done.wait();
+        } // workers are stopped & joined
+
+        CHECK(counter == 1000);
+    }
+}
+
+namespace Benchmarks
+{
+    // baseline for the contention benchmark
+    template <typename T>
+    class MutexQueue
+    {
+        std::mutex mtx_;
+        std::deque<T> items_;
+        const size_t capacity_;
+
+    public:
+        explicit MutexQueue(size_t capacity)
+            : capacity_{capacity}
+        { }
+
+        bool try_push(T value)
+        {
+            std::lock_guard lk{mtx_};
+            if (items_.size() == capacity_)
+                return false;
+            items_.push_back(std::move(value));
+            return true;
+        }
+
+        std::optional<T> try_pop()
+        {
+            std::lock_guard lk{mtx_};
+            if (items_.empty())
+                return std::nullopt;
+            T item = std::move(items_.front());
+            items_.pop_front();
+            return item;
+        }
+    };
+
+    // every thread pushes & pops in turns - reports ops/sec & p99 of (sampled) enqueue latency
+    template <typename TQueue>
+    void run_contention(std::string_view name, int no_of_threads)
+    {
+        constexpr int ops_per_thread = 200'000;
+        constexpr int sampling_rate = 16;
+
+        TQueue queue(1024);
+        std::vector<std::vector<std::chrono::nanoseconds>> latencies(no_of_threads);
+        std::latch all_ready{no_of_threads + 1};
+
+        auto start = std::chrono::steady_clock::now();
+        {
+            std::vector<std::jthread> threads;
+            for (int t = 0; t < no_of_threads; ++t)
+                threads.emplace_back([&, t] {
+                    latencies[t].reserve(ops_per_thread / sampling_rate);
+                    all_ready.arrive_and_wait();
+
+                    for (int i = 0; i < ops_per_thread; ++i)
+                    {
+                        const bool is_sampled = i % sampling_rate == 0;
+                        const auto push_start = is_sampled ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+
+                        while (!queue.try_push(i))
+                            std::this_thread::yield();
+
+                        if (is_sampled)
+                            latencies[t].push_back(std::chrono::steady_clock::now() - push_start);
+
+                        while (!queue.try_pop())
+                            std::this_thread::yield();
+                    }
+                });
+
+            all_ready.arrive_and_wait();
+            start = std::chrono::steady_clock::now();
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::vector<std::chrono::nanoseconds> all_latencies;
+        for (const auto& thread_latencies : latencies)
+            all_latencies.insert(all_latencies.end(), thread_latencies.begin(), thread_latencies.end());
+        const auto p99 = all_latencies.begin() + all_latencies.size() * 99 / 100;
+        std::ranges::nth_element(all_latencies, p99);
+
+        const double ops_per_sec = 2.0 * ops_per_thread * no_of_threads / elapsed.count();
+        std::cout << name << " - " << no_of_threads << " threads: " << static_cast<long long>(ops_per_sec) << " ops/sec, "
+                  << "p99 enqueue latency: " << p99->count() << "ns\n";
+    }
+} // namespace Benchmarks
+
+TEST_CASE("MpmcQueue vs. mutex + deque - contention", "[.][benchmark]")
+{
+    for (const int no_of_threads : {1, 2, 4, 8, 16, 32, 64})
+    {
+        Benchmarks::run_contention<Concurrency::MpmcQueue<int>>("MpmcQueue", no_of_threads);
+        Benchmarks::run_contention<Benchmarks::MutexQueue<int>>("mutex + deque", no_of_threads);
+    }
+}
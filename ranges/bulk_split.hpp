@@ -0,0 +1,174 @@
+#ifndef BULK_SPLIT_HPP
+#define BULK_SPLIT_HPP
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+namespace Parsing
+{
+    using KeyValue = std::pair<std::string_view, std::string_view>;
+
+    ///////////////////////////////////////////////////////////////////////
+    // Bulk splitting of "key<separator>value" lines
+    //  - the buffer is scanned in 64-byte blocks: every block yields a bitmask of newlines
+    //    and a bitmask of separators (AVX2: 2 x 32 bytes, SSE2: 4 x 16 bytes, scalar fallback otherwise)
+    //  - the set bits are visited in order, so the per-byte work is done by the vector compares
+    //  - every line gives one (key, value) pair - same semantics as split(line):
+    //    the first separator splits the line, a line without a separator gives ("", "")
+
+    namespace Detail
+    {
+        inline constexpr size_t block_size = 64;
+
+        struct BlockMasks
+        {
+            uint64_t newlines;
+            uint64_t separators;
+        };
+
+#if defined(__AVX2__)
+        inline constexpr std::string_view simd_kind = "AVX2";
+
+        inline BlockMasks scan_block(const char* block, char separator) noexcept
+        {
+            const __m256i nl = _mm256_set1_epi8('\n');
+            const __m256i sep = _mm256_set1_epi8(separator);
+            const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+            const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 32));
+
+            auto mask = [](__m256i lo, __m256i hi) {
+                return static_cast<uint32_t>(_mm256_movemask_epi8(lo)) | (uint64_t{static_cast<uint32_t>(_mm256_movemask_epi8(hi))} << 32);
+            };
+
+            return {mask(_mm256_cmpeq_epi8(lo, nl), _mm256_cmpeq_epi8(hi, nl)),
+                mask(_mm256_cmpeq_epi8(lo, sep), _mm256_cmpeq_epi8(hi, sep))};
+        }
+#elif defined(__SSE2__) || defined(_M_X64)
+        inline constexpr std::string_view simd_kind = "SSE2";
+
+        inline BlockMasks scan_block(const char* block, char separator) noexcept
+        {
+            const __m128i nl = _mm_set1_epi8('\n');
+            const __m128i sep = _mm_set1_epi8(separator);
+
+            BlockMasks masks{0, 0};
+            for (int i = 0; i < 4; ++i)
+            {
+                const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * i));
+                masks.newlines |= uint64_t{static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, nl)))} << (16 * i);
+                masks.separators |= uint64_t{static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, sep)))} << (16 * i);
+            }
+
+            return masks;
+        }
+#else
+        inline constexpr std::string_view simd_kind = "scalar";
+
+        inline BlockMasks scan_block(const char* block, char separator) noexcept
+        {
+            BlockMasks masks{0, 0};
+            for (size_t i = 0; i < block_size; ++i)
+            {
+                masks.newlines |= uint64_t{block[i] == '\n'} << i;
+                masks.separators |= uint64_t{block[i] == separator} << i;
+            }
+
+            return masks;
+        }
+#endif
+
+        class LineSplitter
+        {
+            const char* const data_;
+            std::vector<KeyValue>& out_;
+            size_t line_start_ = 0;
+            size_t separator_ = std::string_view::npos; // first separator in the current line
+
+        public:
+            LineSplitter(const char* data, std::vector<KeyValue>& out)
+                : data_{data}
+                , out_{out}
+            {
+            }
+
+            void end_line(size_t pos)
+            {
+                if (separator_ == std::string_view::npos)
+                    out_.emplace_back();
+                else
+                    out_.emplace_back(std::string_view{data_ + line_start_, separator_ - line_start_},
+                        std::string_view{data_ + separator_ + 1, pos - separator_ - 1});
+
+                line_start_ = pos + 1;
+                separator_ = std::string_view::npos;
+            }
+
+            void separator(size_t pos) noexcept
+            {
+                if (separator_ == std::string_view::npos)
+                    separator_ = pos;
+            }
+
+            // visits the set bits of a block in order
+            void process(size_t offset, BlockMasks masks)
+            {
+                for (uint64_t events = masks.newlines | masks.separators; events != 0; events &= events - 1)
+                {
+                    const int bit = std::countr_zero(events);
+                    if (masks.newlines & (uint64_t{1} << bit))
+                        end_line(offset + bit);
+                    else
+                        separator(offset + bit);
+                }
+            }
+
+            void finish(size_t size)
+            {
+                if (line_start_ < size) // last line without '\n'
+                    end_line(size);
+            }
+        };
+    } // namespace Detail
+
+    // appends one (key, value) pair per line of buffer to out
+    inline void split_lines(std::string_view buffer, std::vector<KeyValue>& out, char separator = '/')
+    {
+        using namespace Detail;
+
+        LineSplitter splitter{buffer.data(), out};
+
+        const size_t full_blocks_size = buffer.size() - buffer.size() % block_size;
+        for (size_t offset = 0; offset < full_blocks_size; offset += block_size)
+            splitter.process(offset, scan_block(buffer.data() + offset, separator));
+
+        if (full_blocks_size < buffer.size()) // tail - padded copy, so the block scan never reads past the buffer
+        {
+            char block[block_size] = {};
+            std::memcpy(block, buffer.data() + full_blocks_size, buffer.size() - full_blocks_size);
+
+            BlockMasks masks = scan_block(block, separator);
+            const uint64_t valid = (uint64_t{1} << (buffer.size() - full_blocks_size)) - 1;
+            splitter.process(full_blocks_size, {masks.newlines & valid, masks.separators & valid});
+        }
+
+        splitter.finish(buffer.size());
+    }
+
+    inline std::vector<KeyValue> split_lines(std::string_view buffer, char separator = '/')
+    {
+        std::vector<KeyValue> result;
+        split_lines(buffer, result, separator);
+        return result;
+    }
+} // namespace Parsing
+
+#endif // BULK_SPLIT_HPP
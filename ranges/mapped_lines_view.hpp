@@ -0,0 +1,252 @@
+#ifndef MAPPED_LINES_VIEW_HPP
+#define MAPPED_LINES_VIEW_HPP
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#if __has_include(<sys/mman.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MAPPED_LINES_VIEW_POSIX 1
+#else
+#define MAPPED_LINES_VIEW_POSIX 0
+#endif
+
+namespace Views
+{
+    namespace Detail
+    {
+        // read-only mapping of a whole file (without mmap the file is read into memory)
+        class MappedFile
+        {
+        public:
+            explicit MappedFile(const std::filesystem::path& path)
+            {
+#if MAPPED_LINES_VIEW_POSIX
+                const int fd = ::open(path.c_str(), O_RDONLY);
+                if (fd == -1)
+                    throw std::system_error(errno, std::generic_category(), "cannot open " + path.string());
+
+                struct stat info;
+                if (::fstat(fd, &info) == -1)
+                {
+                    const int error = errno;
+                    ::close(fd);
+                    throw std::system_error(error, std::generic_category(), "cannot stat " + path.string());
+                }
+
+                size_ = static_cast<size_t>(info.st_size);
+                if (size_ > 0)
+                {
+                    void* data = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+                    const int error = errno;
+                    ::close(fd); // the mapping keeps the file open
+
+                    if (data == MAP_FAILED)
+                        throw std::system_error(error, std::generic_category(), "cannot map " + path.string());
+
+                    data_ = static_cast<const char*>(data);
+                    ::madvise(data, size_, MADV_SEQUENTIAL);
+                }
+                else
+                    ::close(fd);
+#else
+                std::ifstream in{path, std::ios::binary};
+                if (!in)
+                    throw std::system_error(std::make_error_code(std::errc::no_such_file_or_directory), "cannot open " + path.string());
+                buffer_.assign(std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{});
+                data_ = buffer_.data();
+                size_ = buffer_.size();
+#endif
+            }
+
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+
+            ~MappedFile()
+            {
+#if MAPPED_LINES_VIEW_POSIX
+                if (data_)
+                    ::munmap(const_cast<char*>(data_), size_);
+#endif
+            }
+
+            std::string_view content() const noexcept
+            {
+                return {data_, size_};
+            }
+
+            // hint: whole pages inside [from, up_to) will not be needed soon - they are dropped from the
+            // process' resident set and transparently read again from the file if touched
+            void release(const char* from, const char* up_to) const noexcept
+            {
+#if MAPPED_LINES_VIEW_POSIX
+                static const size_t page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+                const size_t first_page = (static_cast<size_t>(from - data_) + page_size - 1) / page_size;
+                const size_t last_page = static_cast<size_t>(up_to - data_) / page_size;
+                if (first_page < last_page)
+                    ::madvise(const_cast<char*>(data_) + first_page * page_size, (last_page - first_page) * page_size, MADV_DONTNEED);
+#endif
+            }
+
+        private:
+            const char* data_ = nullptr;
+            size_t size_ = 0;
+#if !MAPPED_LINES_VIEW_POSIX
+            std::string buffer_;
+#endif
+        };
+    } // namespace Detail
+
+    ///////////////////////////////////////////////////////////////////////
+    // View of the lines of a memory-mapped file
+    //  - yields std::string_view lines (without '\n') pointing into the mapping - no copies
+    //  - the mapping is shared by all copies of the view; lines are valid as long as any copy lives
+    //  - while iterating, pages left behind are released every release_window bytes,
+    //    so a multi-GB file is processed in bounded RSS
+    //  - chunks(n) splits the file at line boundaries for parallel processing (the view must outlive them)
+
+    class mapped_lines_view : public std::ranges::view_interface<mapped_lines_view>
+    {
+    public:
+        static constexpr size_t release_window = 64 * 1024 * 1024;
+
+        class iterator
+        {
+        public:
+            using iterator_concept = std::forward_iterator_tag;
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = std::string_view;
+            using difference_type = std::ptrdiff_t;
+
+            iterator() = default;
+
+            iterator(const Detail::MappedFile* file, const char* begin, const char* end)
+                : file_{file}
+                , line_{begin}
+                , end_{end}
+                , released_{begin}
+            {
+                find_eol();
+            }
+
+            std::string_view operator*() const noexcept
+            {
+                return {line_, static_cast<size_t>(eol_ - line_)};
+            }
+
+            iterator& operator++()
+            {
+                line_ = (eol_ == end_) ? end_ : eol_ + 1;
+                find_eol();
+
+                if (static_cast<size_t>(line_ - released_) >= release_window)
+                {
+                    file_->release(released_, line_);
+                    released_ = line_;
+                }
+
+                return *this;
+            }
+
+            iterator operator++(int)
+            {
+                iterator temp = *this;
+                ++*this;
+                return temp;
+            }
+
+            bool operator==(const iterator& other) const noexcept
+            {
+                return line_ == other.line_;
+            }
+
+            bool operator==(std::default_sentinel_t) const noexcept
+            {
+                return line_ == end_;
+            }
+
+        private:
+            const Detail::MappedFile* file_ = nullptr;
+            const char* line_ = nullptr;
+            const char* eol_ = nullptr;
+            const char* end_ = nullptr;
+            const char* released_ = nullptr;
+
+            void find_eol() noexcept
+            {
+                if (line_ == end_)
+                    eol_ = end_;
+                else if (const void* eol = std::memchr(line_, '\n', static_cast<size_t>(end_ - line_)))
+                    eol_ = static_cast<const char*>(eol);
+                else
+                    eol_ = end_;
+            }
+        };
+
+        mapped_lines_view() = default;
+
+        explicit mapped_lines_view(const std::filesystem::path& path)
+            : file_{std::make_shared<const Detail::MappedFile>(path)}
+        {
+        }
+
+        iterator begin() const
+        {
+            const std::string_view content = file_ ? file_->content() : std::string_view{};
+            return iterator{file_.get(), content.data(), content.data() + content.size()};
+        }
+
+        std::default_sentinel_t end() const noexcept
+        {
+            return std::default_sentinel;
+        }
+
+        using chunk = std::ranges::subrange<iterator, std::default_sentinel_t>;
+
+        // splits the lines into at most no_of_chunks ranges of roughly equal size in bytes
+        std::vector<chunk> chunks(size_t no_of_chunks) const
+        {
+            const std::string_view content = file_ ? file_->content() : std::string_view{};
+            const char* const end = content.data() + content.size();
+
+            std::vector<chunk> result;
+            for (const char* chunk_begin = content.data(); chunk_begin != end;)
+            {
+                const size_t chunk_size = std::max<size_t>(content.size() / std::max<size_t>(no_of_chunks, 1), 1);
+                const char* chunk_end = chunk_begin + std::min(chunk_size, static_cast<size_t>(end - chunk_begin));
+
+                if (const void* eol = std::memchr(chunk_end - 1, '\n', static_cast<size_t>(end - chunk_end + 1)))
+                    chunk_end = static_cast<const char*>(eol) + 1; // a chunk ends after a newline
+                else
+                    chunk_end = end;
+
+                result.emplace_back(iterator{file_.get(), chunk_begin, chunk_end}, std::default_sentinel);
+                chunk_begin = chunk_end;
+            }
+
+            return result;
+        }
+
+    private:
+        std::shared_ptr<const Detail::MappedFile> file_;
+    };
+
+    static_assert(std::ranges::forward_range<mapped_lines_view>);
+    static_assert(std::ranges::view<mapped_lines_view>);
+} // namespace Views
+
+#endif // MAPPED_LINES_VIEW_HPP
@@ -0,0 +1,141 @@
+#ifndef MATERIALIZE_HPP
+#define MATERIALIZE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <ranges>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Views
+{
+    namespace Detail
+    {
+        // single pass - std::vector(first, last) would traverse a non-sized forward range twice
+        template <std::ranges::input_range TRange>
+        auto to_vector(TRange&& rng)
+        {
+            std::vector<std::ranges::range_value_t<TRange>> items;
+            if constexpr (std::ranges::sized_range<TRange>)
+                items.reserve(std::ranges::size(rng));
+            for (auto&& item : rng)
+                items.push_back(std::forward<decltype(item)>(item));
+            return items;
+        }
+    } // namespace Detail
+
+    ///////////////////////////////////////////////////////////////////////
+    // Evaluating a (lazy) pipeline once
+    //  - rng | materialize(arena) - copies the elements into one block of the arena's memory
+    //    and returns a std::span over it: a borrowed view - valid as long as the arena
+    //  - rng | cache_all - the same, but the view owns the buffer (shared by its copies)
+    //  - copying & iterating the result again never re-runs predicates or transformations
+
+    template <typename T>
+    class cached_view : public std::ranges::view_interface<cached_view<T>>
+    {
+    public:
+        cached_view() = default;
+
+        template <std::ranges::input_range TRange>
+        explicit cached_view(TRange&& rng)
+            : items_{std::make_shared<const std::vector<T>>(Detail::to_vector(std::forward<TRange>(rng)))}
+        {
+        }
+
+        const T* begin() const noexcept
+        {
+            return items_ ? items_->data() : nullptr;
+        }
+
+        const T* end() const noexcept
+        {
+            return items_ ? items_->data() + items_->size() : nullptr;
+        }
+
+    private:
+        std::shared_ptr<const std::vector<T>> items_;
+    };
+
+    namespace Detail
+    {
+        struct CacheAll
+        {
+            template <std::ranges::input_range TRange>
+            auto operator()(TRange&& rng) const
+            {
+                return cached_view<std::ranges::range_value_t<TRange>>{std::forward<TRange>(rng)};
+            }
+
+            template <std::ranges::input_range TRange>
+            friend auto operator|(TRange&& rng, const CacheAll& cache_all)
+            {
+                return cache_all(std::forward<TRange>(rng));
+            }
+        };
+
+        // the arena never runs destructors
+        template <typename TRange>
+        concept ArenaStorable = std::ranges::input_range<TRange>
+            && std::is_trivially_destructible_v<std::ranges::range_value_t<TRange>>;
+
+        class Materialize
+        {
+            std::pmr::memory_resource* arena_;
+
+        public:
+            explicit Materialize(std::pmr::memory_resource& arena)
+                : arena_{&arena}
+            {
+            }
+
+            template <ArenaStorable TRange>
+            auto operator()(TRange&& rng) const
+            {
+                using T = std::ranges::range_value_t<TRange>;
+
+                if constexpr (std::ranges::sized_range<TRange>)
+                    return copy_to_arena<T>(std::ranges::size(rng), std::ranges::begin(rng));
+                else
+                {
+                    // size unknown - evaluate into a temporary buffer, so the arena gets an exactly sized block
+                    const std::vector<T> items = to_vector(std::forward<TRange>(rng));
+                    return copy_to_arena<T>(items.size(), items.begin());
+                }
+            }
+
+            template <ArenaStorable TRange>
+            friend auto operator|(TRange&& rng, const Materialize& materialize)
+            {
+                return materialize(std::forward<TRange>(rng));
+            }
+
+        private:
+            template <typename T, typename TIterator>
+            std::span<const T> copy_to_arena(size_t size, TIterator first) const
+            {
+                if (size == 0)
+                    return {};
+
+                T* items = static_cast<T*>(arena_->allocate(size * sizeof(T), alignof(T)));
+                std::ranges::uninitialized_copy_n(first, size, items, items + size);
+
+                return {items, size};
+            }
+        };
+    } // namespace Detail
+
+    inline constexpr Detail::CacheAll cache_all;
+
+    inline Detail::Materialize materialize(std::pmr::memory_resource& arena)
+    {
+        return Detail::Materialize{arena};
+    }
+} // namespace Views
+
+#endif // MATERIALIZE_HPP
@@ -0,0 +1,184 @@
+#ifndef PARALLEL_PIPELINE_HPP
+#define PARALLEL_PIPELINE_HPP
+
+#include "../multithreading/thread_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <latch>
+#include <memory>
+#include <mutex>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Parallel
+{
+    ///////////////////////////////////////////////////////////////////////
+    // Parallel, chunked execution of range pipelines
+    //  - the source is split into chunks: random-access sized ranges by index,
+    //    sources with a chunks(n) member (e.g. mapped_lines_view) at their own boundaries
+    //  - every chunk is piped through the pipeline on a thread pool & collected into a vector
+    //  - results are merged in source order (default) or in order of completion
+    //  - only element-wise stages (filter, transform, elements, ...) give the same result as a
+    //    sequential run - stateful ones (drop_while, take, ...) would apply per chunk
+    //  - chunks are claimed one by one by the pool's tasks and by the caller itself -
+    //    par_collect may be called from a task of the same pool
+
+    enum class Order
+    {
+        preserved,
+        unordered
+    };
+
+    struct Options
+    {
+        size_t no_of_chunks = 0; // 0 - four chunks per worker
+        Order order = Order::preserved;
+    };
+
+    template <typename TSource>
+    concept Chunkable = requires(const TSource& source, size_t n) {
+        { source.chunks(n) } -> std::ranges::random_access_range;
+    };
+
+    template <typename TSource>
+    concept ParallelSource = (std::ranges::random_access_range<TSource> && std::ranges::sized_range<TSource>)
+        || Chunkable<std::remove_cvref_t<TSource>>;
+
+    namespace Detail
+    {
+        template <typename TSource>
+        auto make_chunks(TSource& source, size_t no_of_chunks)
+        {
+            if constexpr (Chunkable<std::remove_cvref_t<TSource>>)
+                return source.chunks(no_of_chunks);
+            else
+            {
+                using Chunk = std::ranges::subrange<std::ranges::iterator_t<TSource>>;
+                using Difference = std::ranges::range_difference_t<TSource>;
+
+                const Difference size = std::ranges::distance(source);
+                const Difference n = std::clamp<Difference>(static_cast<Difference>(no_of_chunks), 1, std::max<Difference>(size, 1));
+
+                std::vector<Chunk> chunks;
+                chunks.reserve(static_cast<size_t>(n));
+                auto first = std::ranges::begin(source);
+                for (Difference i = 0; i < n; ++i)
+                {
+                    auto last = std::ranges::begin(source) + size * (i + 1) / n;
+                    chunks.emplace_back(first, last);
+                    first = last;
+                }
+
+                return chunks;
+            }
+        }
+    } // namespace Detail
+
+    template <ParallelSource TSource, typename TPipeline>
+    auto par_collect(TSource&& source, const TPipeline& pipeline, Concurrency::ThreadPool& pool, Options options = {})
+    {
+        auto chunks = Detail::make_chunks(source, options.no_of_chunks ? options.no_of_chunks : 4 * pool.size());
+
+        using Chunk = std::ranges::range_value_t<decltype(chunks)>;
+        using Result = std::ranges::range_value_t<decltype(std::declval<Chunk&>() | pipeline)>;
+
+        std::vector<Result> result;
+        std::vector<std::vector<Result>> partial_results(std::ranges::size(chunks));
+        std::mutex mtx;
+        std::exception_ptr error;
+
+        // outlives the call - a task that starts after the last chunk is claimed touches nothing else
+        struct State
+        {
+            std::atomic<size_t> next_chunk{0};
+            std::latch done;
+
+            explicit State(size_t no_of_chunks)
+                : done{static_cast<std::ptrdiff_t>(no_of_chunks)}
+            {
+            }
+        };
+        auto state = std::make_shared<State>(partial_results.size());
+
+        auto process_chunk = [&](size_t i) {
+            try
+            {
+                for (auto&& item : chunks[i] | pipeline)
+                    partial_results[i].push_back(std::forward<decltype(item)>(item));
+
+                if (options.order == Order::unordered)
+                {
+                    std::lock_guard lk{mtx};
+                    std::ranges::move(partial_results[i], std::back_inserter(result));
+                }
+            }
+            catch (...)
+            {
+                std::lock_guard lk{mtx};
+                if (!error)
+                    error = std::current_exception();
+            }
+        };
+
+        auto claim_chunks = [state, &process_chunk, no_of_chunks = partial_results.size()] {
+            for (size_t i; (i = state->next_chunk.fetch_add(1)) < no_of_chunks;)
+            {
+                process_chunk(i);
+                state->done.count_down();
+            }
+        };
+
+        for (size_t t = 0; t < std::min(partial_results.size(), pool.size()); ++t)
+            pool.submit(claim_chunks);
+
+        // the caller claims chunks as well - it never waits for chunks nobody has started,
+        // so it may be a task of the same pool & a stopped or busy pool doesn't block it
+        claim_chunks();
+        state->done.wait();
+
+        if (error)
+            std::rethrow_exception(error);
+
+        if (options.order == Order::preserved)
+        {
+            size_t total_size = 0;
+            for (const auto& partial : partial_results)
+                total_size += partial.size();
+
+            result.reserve(total_size);
+            for (auto& partial : partial_results)
+                std::ranges::move(partial, std::back_inserter(result));
+        }
+
+        return result;
+    }
+
+    // source | par_collect(pipeline, pool)
+    template <typename TPipeline>
+    struct ParCollect
+    {
+        TPipeline pipeline;
+        Concurrency::ThreadPool& pool;
+        Options options;
+
+        template <ParallelSource TSource>
+        friend auto operator|(TSource&& source, const ParCollect& collect)
+        {
+            return par_collect(std::forward<TSource>(source), collect.pipeline, collect.pool, collect.options);
+        }
+    };
+
+    template <typename TPipeline>
+    ParCollect<TPipeline> par_collect(TPipeline pipeline, Concurrency::ThreadPool& pool, Options options = {})
+    {
+        return {std::move(pipeline), pool, options};
+    }
+} // namespace Parallel
+
+#endif // PARALLEL_PIPELINE_HPP
@@ -1,17 +1,81 @@
 #include "../helpers.hpp"
+#include "bulk_split.hpp"
+#include "mapped_lines_view.hpp"
+#include "materialize.hpp"
+#include "parallel_pipeline.hpp"
+#include "simd_search.hpp"
 
 #include <algorithm>
 #include <array>
 #include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <limits>
+#include <numeric>
+#include <random>
 #include <ranges>
+#include <sstream>
 #include <string>
 #include <vector>
 
+#if __has_include(<sys/resource.h>)
+#include <sys/resource.h>
+#endif
+
 using namespace std::literals;
 
 using namespace Helpers;
 
+namespace
+{
+    class TempFile
+    {
+        std::filesystem::path path_;
+
+    public:
+        TempFile(std::string_view name)
+            : path_{std::filesystem::temp_directory_path() / name}
+        {
+        }
+
+        TempFile(const TempFile&) = delete;
+        TempFile& operator=(const TempFile&) = delete;
+
+        ~TempFile()
+        {
+            std::error_code ec;
+            std::filesystem::remove(path_, ec);
+        }
+
+        const std::filesystem::path& path() const
+        {
+            return path_;
+        }
+
+        void write(std::string_view content) const
+        {
+            std::ofstream{path_, std::ios::binary}.write(content.data(), content.size());
+        }
+    };
+
+    long peak_rss_in_kb()
+    {
+#if __has_include(<sys/resource.h>)
+        rusage usage{};
+        ::getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_maxrss;
+#else
+        return -1;
+#endif
+    }
+} // namespace
+
 struct Value
 {
     int v;
@@ -68,6 +132,150 @@ TEST_CASE("algorithms with sentinels")
     print(head_vec, "head_vec");
 }
 
+TEST_CASE("SIMD search - find, count, find_if(equal_to)")
+{
+    std::vector<int> vec(1000);
+    std::iota(vec.begin(), vec.end(), 0);
+
+    SECTION("find")
+    {
+        for (int value : {0, 1, 7, 8, 31, 32, 500, 998, 999})
+        {
+            CHECK(Search::find(vec, value) == vec.begin() + value);
+            CHECK(Search::find(vec.begin() + value / 2, std::unreachable_sentinel, value) == vec.begin() + value);
+            CHECK(Search::find_if(vec, Search::equal_to(value)) == vec.begin() + value);
+        }
+
+        CHECK(Search::find(vec, 1000) == vec.end());
+        CHECK(Search::find(vec, 1LL << 32) == vec.end()); // not representable as int
+    }
+
+    SECTION("count")
+    {
+        const std::vector ds = create_numeric_dataset(10'001, 1, 10);
+
+        for (int value : {1, 5, 10, 11})
+            CHECK(Search::count(ds, value) == std::ranges::count(ds, value));
+    }
+
+    SECTION("all element sizes")
+    {
+        auto check_type = [](auto tag) {
+            using T = decltype(tag);
+            constexpr T needle = std::numeric_limits<T>::max();
+            std::vector<T> items(777, T{3});
+            items[700] = needle;
+            items[776] = needle;
+
+            CHECK(Search::find(items, needle) == items.begin() + 700);
+            CHECK(Search::find(items.begin() + 701, std::unreachable_sentinel, needle) == items.begin() + 776);
+            CHECK(Search::count(items, T{3}) == 775);
+        };
+
+        check_type(int8_t{});
+        check_type(uint16_t{});
+        check_type(int32_t{});
+        check_type(int64_t{});
+    }
+
+    SECTION("fallbacks")
+    {
+        std::list<int> lst = {1, 2, 42, 3};
+        CHECK(*Search::find(lst, 42) == 42);
+        CHECK(Search::count(lst, 42) == 1);
+        CHECK(*Search::find_if(vec, [](int x) { return x > 10; }) == 11);
+        CHECK(Search::find(vec.begin(), EndValue<42>{}, 50) == vec.begin() + 42);
+    }
+}
+
+TEST_CASE("SIMD search vs. std::ranges::find - 1K-100M ints", "[.][benchmark]")
+{
+    for (size_t size : {1'000ul, 10'000ul, 100'000ul, 1'000'000ul, 10'000'000ul, 100'000'000ul})
+    {
+        std::vector<int> vec(size, 0);
+        vec.back() = 42; // worst case - the whole vector is scanned
+
+        const size_t no_of_runs = std::max<size_t>(1, 1'000'000'000 / size);
+
+        auto measure = [&](std::string_view name, auto search) {
+            const auto start = std::chrono::steady_clock::now();
+            size_t checksum = 0;
+            for (size_t run = 0; run < no_of_runs; ++run)
+            {
+                checksum += search();
+                std::atomic_signal_fence(std::memory_order_seq_cst);
+            }
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+            std::cout << std::setw(10) << size << " ints - " << std::setw(36) << std::left << name << std::right << ": "
+                      << std::setw(8) << std::fixed << std::setprecision(2) << (size * sizeof(int) * no_of_runs) / elapsed.count() / 1e9
+                      << " GB/s (" << checksum / no_of_runs << ")\n";
+        };
+
+        auto index = [&](auto pos) { return static_cast<size_t>(pos - vec.begin()); };
+
+        measure("std::ranges::find", [&] { return index(std::ranges::find(vec, 42)); });
+        measure("std::ranges::find(unreachable)", [&] { return index(std::ranges::find(vec.begin(), std::unreachable_sentinel, 42)); });
+        measure("Search::find", [&] { return index(Search::find(vec, 42)); });
+        measure("Search::find(unreachable)", [&] { return index(Search::find(vec.begin(), std::unreachable_sentinel, 42)); });
+        measure("std::ranges::count", [&] { return static_cast<size_t>(std::ranges::count(vec, 42)); });
+        measure("Search::count", [&] { return static_cast<size_t>(Search::count(vec, 42)); });
+        std::cout << std::defaultfloat;
+    }
+}
+
+TEST_CASE("parallel dataset generator")
+{
+    const auto reference = create_numeric_dataset(1'000'000, -100, 100, {.seed = 665, .no_of_threads = 1});
+
+    CHECK(std::ranges::all_of(reference, [](int x) { return -100 <= x && x <= 100; }));
+    CHECK(std::ranges::count(reference, -100) > 0);
+    CHECK(std::ranges::count(reference, 100) > 0);
+
+    for (unsigned no_of_threads : {2u, 3u, 8u})
+        CHECK(create_numeric_dataset(1'000'000, -100, 100, {.seed = 665, .no_of_threads = no_of_threads}) == reference);
+
+    CHECK(create_numeric_dataset(1'000'000, -100, 100, {.seed = 666}) != reference);
+
+    SECTION("full int range")
+    {
+        const auto data = create_numeric_dataset(1000, std::numeric_limits<int>::min(), std::numeric_limits<int>::max(), {});
+        CHECK(std::ranges::minmax(data).min < -1'000'000'000);
+        CHECK(std::ranges::minmax(data).max > 1'000'000'000);
+    }
+
+    SECTION("memory-mapped file")
+    {
+        TempFile file{"numeric_dataset_test.bin"};
+        create_numeric_dataset_file(file.path(), reference.size(), -100, 100, {.seed = 665});
+
+        std::vector<int> from_file(reference.size());
+        std::ifstream{file.path(), std::ios::binary}.read(reinterpret_cast<char*>(from_file.data()), from_file.size() * sizeof(int));
+        CHECK(from_file == reference);
+    }
+}
+
+TEST_CASE("parallel dataset generator - GB/s", "[.][benchmark]")
+{
+    constexpr size_t size = 100'000'000;
+
+    auto report = [&](std::string_view name, auto generate) {
+        const auto start = std::chrono::steady_clock::now();
+        generate();
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << name << ": " << size * sizeof(int) / elapsed.count() / 1e9 << " GB/s\n";
+    };
+
+    report("mt19937 + uniform_int_distribution", [] { return create_numeric_dataset(size).size(); });
+
+    for (unsigned no_of_threads = 1; no_of_threads <= std::max(4u, std::thread::hardware_concurrency()); no_of_threads *= 2)
+        report("splitmix64 - " + std::to_string(no_of_threads) + " thread(s)",
+            [=] { return create_numeric_dataset(size, -100, 100, {.no_of_threads = no_of_threads}).size(); });
+
+    TempFile file{"numeric_dataset_benchmark.bin"};
+    report("splitmix64 - mmapped file", [&] { create_numeric_dataset_file(file.path(), size, -100, 100); });
+}
+
 TEST_CASE("views")
 {
     std::vector ds = create_numeric_dataset(20);
@@ -148,10 +356,7 @@ namespace Views
         && requires(std::ranges::range_value_t<T> obj) { std::cout << obj; };
     void print(PrintableView auto rng, std::string_view prefix = "items")
     {
-        std::cout << prefix << ": [ ";
-        for (const auto& item : rng)
-            std::cout << item << " ";
-        std::cout << "]\n";
+        Helpers::print(rng, prefix); // buffered std::to_chars fast path for numbers
     }
 } // namespace Views
 
@@ -169,6 +374,163 @@ TEST_CASE("passing views")
     Views::print(std::views::all(vec), "vec");
 }
 
+TEST_CASE("materialize & cache_all")
+{
+    std::vector ds = create_numeric_dataset(20);
+
+    int no_of_calls = 0;
+    auto is_even = [&no_of_calls](int x) { ++no_of_calls; return x % 2 == 0; };
+
+    auto tail_ds = ds
+        | std::views::drop(10)
+        | std::views::filter(is_even);
+
+    auto expected = tail_ds | std::views::transform([](int x) { return x; });
+    const std::vector<int> expected_items(expected.begin(), expected.end());
+
+    SECTION("cache_all")
+    {
+        no_of_calls = 0;
+        auto cached_ds = tail_ds | Views::cache_all;
+        CHECK(no_of_calls == 10);
+
+        static_assert(std::ranges::view<decltype(cached_ds)>);
+        static_assert(std::ranges::contiguous_range<decltype(cached_ds)>);
+
+        Views::print(cached_ds, "cached_ds");
+        Views::print(cached_ds, "cached_ds");
+        CHECK(std::ranges::equal(cached_ds, expected_items));
+        CHECK(no_of_calls == 10);
+    }
+
+    SECTION("materialize in an arena")
+    {
+        std::pmr::monotonic_buffer_resource arena;
+
+        no_of_calls = 0;
+        auto materialized_ds = tail_ds | Views::materialize(arena);
+        CHECK(no_of_calls == 10);
+
+        static_assert(std::ranges::borrowed_range<decltype(materialized_ds)>);
+        static_assert(std::ranges::view<decltype(materialized_ds)>);
+
+        auto pos = std::ranges::find(tail_ds | Views::materialize(arena), expected_items.back()); // no dangling - the arena owns the items
+        CHECK(*pos == expected_items.back());
+
+        Views::print(materialized_ds, "materialized_ds");
+        CHECK(std::ranges::equal(materialized_ds, expected_items));
+    }
+}
+
+TEST_CASE("materialize - expensive predicate iterated many times", "[.][benchmark]")
+{
+    constexpr int no_of_passes = 8;
+    const std::vector ds = create_numeric_dataset(200'000, 1, 1'000'000);
+
+    auto is_prime = [](int x) {
+        if (x < 2)
+            return false;
+        for (int d = 2; d * d <= x; ++d)
+            if (x % d == 0)
+                return false;
+        return true;
+    };
+
+    auto primes = ds | std::views::filter(is_prime);
+
+    auto consume = [](auto view) { // by value - like Views::print
+        long long sum = 0;
+        for (int x : view)
+            sum += x;
+        return sum;
+    };
+
+    auto measure = [&](std::string_view name, auto make_view) {
+        const auto start = std::chrono::steady_clock::now();
+        auto view = make_view();
+        long long checksum = 0;
+        for (int pass = 0; pass < no_of_passes; ++pass)
+            checksum += consume(view);
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::cout << name << " - " << no_of_passes << " passes: " << elapsed.count() << " ms (checksum: " << checksum << ")\n";
+    };
+
+    measure("std::views::filter", [&] { return primes; });
+    measure("cache_all", [&] { return primes | Views::cache_all; });
+
+    std::pmr::monotonic_buffer_resource arena;
+    measure("materialize(arena)", [&] { return primes | Views::materialize(arena); });
+}
+
+namespace
+{
+    std::string captured_output(auto print_items)
+    {
+        std::ostringstream out;
+        auto* cout_buffer = std::cout.rdbuf(out.rdbuf());
+        print_items();
+        std::cout.rdbuf(cout_buffer);
+        return out.str();
+    }
+} // namespace
+
+TEST_CASE("print - buffered fast path")
+{
+    std::vector vec = {1, -20, 300, 0};
+    CHECK(captured_output([&] { print(vec, "vec"); }) == "vec: [ 1 -20 300 0 ]\n");
+    CHECK(captured_output([&] { Views::print(std::views::all(vec), "vec"); }) == "vec: [ 1 -20 300 0 ]\n");
+
+    std::vector<double> doubles = {3.14159265, 0.1, 1e20, -2.0};
+    std::ostringstream expected;
+    for (double d : doubles)
+        expected << d << " ";
+    CHECK(captured_output([&] { print(doubles, "doubles"); }) == "doubles: [ " + expected.str() + "]\n");
+
+    SECTION("large ranges are flushed in blocks")
+    {
+        auto numbers = std::views::iota(0, 100'000);
+        std::ostringstream expected;
+        for (int x : numbers)
+            expected << x << " ";
+        CHECK(captured_output([&] { print(numbers, "numbers"); }) == "numbers: [ " + expected.str() + "]\n");
+    }
+
+    SECTION("fallback to operator<<")
+    {
+        std::vector chars = {'a', 'b'};
+        CHECK(captured_output([&] { print(chars, "chars"); }) == "chars: [ a b ]\n");
+
+        std::cout << std::fixed;
+        CHECK(captured_output([&] { print(doubles, "fixed"); }) == "fixed: [ 3.141593 0.100000 100000000000000000000.000000 -2.000000 ]\n");
+        std::cout << std::defaultfloat;
+    }
+}
+
+TEST_CASE("print - 10M ints to /dev/null", "[.][benchmark]")
+{
+    const std::vector data = create_numeric_dataset(10'000'000, std::numeric_limits<int>::min(), std::numeric_limits<int>::max(), {});
+
+    std::ofstream dev_null{"/dev/null"};
+    auto measure = [&](std::string_view name, auto print_items) {
+        auto* cout_buffer = std::cout.rdbuf(dev_null.rdbuf());
+        const auto start = std::chrono::steady_clock::now();
+        print_items();
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout.rdbuf(cout_buffer);
+
+        std::cout << name << ": " << elapsed.count() << " ms\n";
+    };
+
+    measure("std::cout << item << \" \"", [&] {
+        std::cout << "data: [ ";
+        for (const auto& item : data)
+            std::cout << item << " ";
+        std::cout << "]\n";
+    });
+    measure("Helpers::print (std::to_chars + 64 KB blocks)", [&] { print(data, "data"); });
+}
+
 TEST_CASE("borrowed iterator")
 {
     SECTION("dangling iterator")
@@ -215,7 +577,100 @@ TEST_CASE("split")
     CHECK(split(s3) == std::pair{"345"sv, ""sv});
 
     std::string s4 = "/434";
-    CHECK(split(s3) == std::pair{""sv, "434"sv});
+    CHECK(split(s4) == std::pair{""sv, "434"sv});
+}
+
+namespace
+{
+    // reference: current per-line approach
+    void split_line_by_line(std::string_view buffer, std::vector<Parsing::KeyValue>& result)
+    {
+        while (!buffer.empty())
+        {
+            const auto eol = buffer.find('\n');
+            const auto line = buffer.substr(0, eol);
+            result.push_back(split(line));
+            buffer.remove_prefix(eol == std::string_view::npos ? buffer.size() : eol + 1);
+        }
+    }
+
+    std::vector<Parsing::KeyValue> split_line_by_line(std::string_view buffer)
+    {
+        std::vector<Parsing::KeyValue> result;
+        split_line_by_line(buffer, result);
+        return result;
+    }
+
+    std::string create_key_value_lines(size_t no_of_lines)
+    {
+        std::string buffer;
+        std::mt19937 rnd_gen{665};
+        std::uniform_int_distribution<> value_length(0, 40);
+
+        for (size_t i = 0; i < no_of_lines; ++i)
+        {
+            buffer += std::to_string(rnd_gen());
+            buffer += '/';
+            buffer += std::string(value_length(rnd_gen), 'a' + i % 26);
+            buffer += '\n';
+        }
+
+        return buffer;
+    }
+} // namespace
+
+TEST_CASE("split_lines - bulk")
+{
+    INFO("SIMD: " << Parsing::Detail::simd_kind);
+
+    SECTION("same results as split() line by line")
+    {
+        const std::string buffer = "324/44\n4343\n345/\n/434\n\nkey/value/with/slashes\n"
+                                   + std::string(100, 'x') + "/" + std::string(70, 'y') + "\nlast/line";
+
+        CHECK(Parsing::split_lines(buffer) == split_line_by_line(buffer));
+        CHECK(Parsing::split_lines(buffer).back() == std::pair{"last"sv, "line"sv});
+    }
+
+    SECTION("lines crossing block boundaries")
+    {
+        const std::string buffer = create_key_value_lines(1'000);
+
+        for (size_t size : {0, 1, 63, 64, 65, 127, 128, 1000})
+            CHECK(Parsing::split_lines(std::string_view{buffer}.substr(0, size)) == split_line_by_line(std::string_view{buffer}.substr(0, size)));
+        CHECK(Parsing::split_lines(buffer) == split_line_by_line(buffer));
+    }
+
+    SECTION("custom separator")
+    {
+        CHECK(Parsing::split_lines("a=1\nb=2", '=') == std::vector<Parsing::KeyValue>{{"a", "1"}, {"b", "2"}});
+    }
+}
+
+TEST_CASE("split_lines - bulk vs. line by line - GB/s", "[.][benchmark]")
+{
+    const std::string buffer = create_key_value_lines(4'000'000);
+
+    std::vector<Parsing::KeyValue> pairs; // reused - measures splitting, not vector growth
+
+    auto measure = [&](std::string_view name, auto split_all) {
+        constexpr int no_of_runs = 5;
+        std::chrono::duration<double> best{std::chrono::hours{1}};
+
+        for (int run = 0; run < no_of_runs; ++run)
+        {
+            pairs.clear();
+            const auto start = std::chrono::steady_clock::now();
+            split_all(buffer, pairs);
+            best = std::min<std::chrono::duration<double>>(best, std::chrono::steady_clock::now() - start);
+        }
+
+        std::cout << name << ": " << buffer.size() / best.count() / 1e9 << " GB/s (" << pairs.size() << " lines)\n";
+    };
+
+    measure("split() line by line", [](std::string_view buffer, auto& pairs) { split_line_by_line(buffer, pairs); });
+    measure("split_lines() - "s + std::string{Parsing::Detail::simd_kind},
+        [](std::string_view buffer, auto& pairs) { Parsing::split_lines(buffer, pairs); });
 }
 
 TEST_CASE("Exercise - ranges")
@@ -246,4 +701,244 @@ TEST_CASE("Exercise - ranges")
     print(result, "result");
 
     CHECK(std::ranges::equal(result, expected_result));
-}
\ No newline at end of file
+}
+
+// the same pipeline as an adaptor closure - works for any range of string-like lines
+//  - blank lines are "\n" (as in the exercise) or "" (lines of a file without their terminator)
+inline constexpr auto record_values = std::views::filter([](std::string_view s) { return !s.empty() && s != "\n"; })
+    | std::views::transform([](std::string_view s) { return split(s); })
+    | std::views::elements<1>; // element-wise stages only - can run on chunks in parallel
+
+inline constexpr auto values_of_records = std::views::drop_while([](std::string_view s) { return s.starts_with("#"); })
+    | record_values;
+
+TEST_CASE("mapped_lines_view")
+{
+    TempFile file{"mapped_lines_view_test.txt"};
+
+    SECTION("lines without '\\n'")
+    {
+        file.write("first\n\nthird\nlast");
+
+        auto lines = Views::mapped_lines_view{file.path()};
+
+        CHECK(std::ranges::equal(lines, std::vector{"first"sv, ""sv, "third"sv, "last"sv}));
+    }
+
+    SECTION("empty file")
+    {
+        file.write("");
+
+        CHECK(std::ranges::empty(Views::mapped_lines_view{file.path()}));
+    }
+
+    SECTION("missing file")
+    {
+        CHECK_THROWS_AS(Views::mapped_lines_view{file.path().string() + ".missing"}, std::system_error);
+    }
+
+    SECTION("Exercise pipeline")
+    {
+        const std::vector<std::string> lines = {"# Comment 1", "# Comment 2", "1/one", "2/two", "", "3/three", "\n", "4/four"};
+
+        std::string content;
+        for (const auto& line : lines)
+            content += line + "\n";
+        file.write(content);
+
+        auto expected_result = {"one"sv, "two"sv, "three"sv, "four"sv};
+
+        CHECK(std::ranges::equal(lines | values_of_records, expected_result));
+        CHECK(std::ranges::equal(Views::mapped_lines_view{file.path()} | values_of_records, expected_result));
+    }
+}
+
+TEST_CASE("mapped_lines_view - lines/s & peak RSS", "[.][benchmark]")
+{
+    // size of the generated file - 2 GB by default
+    const char* size_in_mb_env = std::getenv("MAPPED_LINES_BENCHMARK_MB");
+    const size_t size_in_mb = size_in_mb_env ? std::stoul(size_in_mb_env) : 2048;
+    constexpr size_t in_memory_limit_in_mb = 256; // std::vector<std::string> baseline runs on a prefix only
+
+    TempFile file{"mapped_lines_view_benchmark.txt"};
+    {
+        const std::string chunk = create_key_value_lines(100'000);
+        std::ofstream out{file.path(), std::ios::binary};
+        out << "# generated key/value records\n";
+        for (size_t written = 0; written < size_in_mb * 1024 * 1024; written += chunk.size())
+            out.write(chunk.data(), chunk.size());
+    }
+
+    auto run = [](std::string_view name, auto&& lines) {
+        const auto start = std::chrono::steady_clock::now();
+
+        size_t no_of_lines = 0;
+        size_t total_length = 0;
+        for (std::string_view value : lines | values_of_records)
+        {
+            ++no_of_lines;
+            total_length += value.size();
+        }
+
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << name << ": " << static_cast<long long>(no_of_lines / elapsed.count()) << " lines/s, "
+                  << "peak RSS: " << peak_rss_in_kb() / 1024 << " MB (" << no_of_lines << " lines, checksum: " << total_length << ")\n";
+    };
+
+    run("mapped_lines_view (" + std::to_string(size_in_mb) + " MB)", Views::mapped_lines_view{file.path()});
+
+    std::vector<std::string> lines;
+    {
+        std::ifstream in{file.path()};
+        size_t read = 0;
+        for (std::string line; read < in_memory_limit_in_mb * 1024 * 1024 && std::getline(in, line);)
+        {
+            read += line.size() + 1;
+            lines.push_back(std::move(line));
+        }
+    }
+    run("std::vector<std::string> (" + std::to_string(std::min(size_in_mb, in_memory_limit_in_mb)) + " MB)", lines);
+}
+
+TEST_CASE("par_collect")
+{
+    Concurrency::ThreadPool pool{4};
+
+    std::vector<std::string> lines;
+    for (int i = 0; i < 10'000; ++i)
+        lines.push_back(i % 10 == 0 ? "" : std::to_string(i) + "/value" + std::to_string(i));
+
+    auto expected = lines | record_values | std::views::transform([](std::string_view s) { return std::string{s}; });
+    const std::vector<std::string> expected_values(expected.begin(), expected.end());
+
+    SECTION("results in source order")
+    {
+        auto values = lines | Parallel::par_collect(record_values, pool);
+
+        CHECK(std::ranges::equal(values, expected_values));
+    }
+
+    SECTION("unordered")
+    {
+        auto values = Parallel::par_collect(lines, record_values, pool, {.no_of_chunks = 64, .order = Parallel::Order::unordered});
+
+        std::vector<std::string> sorted_values(values.begin(), values.end());
+        std::vector<std::string> sorted_expected = expected_values;
+        std::ranges::sort(sorted_values);
+        std::ranges::sort(sorted_expected);
+        CHECK(sorted_values == sorted_expected);
+    }
+
+    SECTION("more chunks than items")
+    {
+        std::vector vec = {1, 2, 3};
+        auto squares = vec | Parallel::par_collect(std::views::transform([](int x) { return x * x; }), pool, {.no_of_chunks = 10});
+
+        CHECK(squares == std::vector{1, 4, 9});
+    }
+
+    SECTION("memory-mapped source")
+    {
+        TempFile file{"par_collect_test.txt"};
+
+        std::string content;
+        for (const auto& line : lines)
+            content += line + "\n";
+        file.write(content);
+
+        Views::mapped_lines_view mapped_lines{file.path()};
+        auto values = mapped_lines | Parallel::par_collect(record_values, pool, {.no_of_chunks = 7});
+
+        CHECK(std::ranges::equal(values, expected_values));
+    }
+
+    SECTION("exceptions are propagated")
+    {
+        auto throwing = std::views::transform([](int x) { if (x == 42) throw std::runtime_error{"42"}; return x; });
+
+        CHECK_THROWS_AS(std::views::iota(0, 100) | Parallel::par_collect(throwing, pool), std::runtime_error);
+    }
+
+    SECTION("called from tasks of a one-thread pool")
+    {
+        Concurrency::ThreadPool single_thread_pool{1};
+        std::vector<std::string> values;
+        std::latch done{1};
+
+        single_thread_pool.submit([&] {
+            auto nested = [&](std::string_view line) {
+                return std::views::single(line) | Parallel::par_collect(record_values, single_thread_pool);
+            };
+            auto outer = lines | Parallel::par_collect(std::views::transform(nested), single_thread_pool);
+
+            for (const auto& inner : outer)
+                values.insert(values.end(), inner.begin(), inner.end());
+            done.count_down();
+        });
+
+        done.wait();
+        CHECK(values == expected_values);
+    }
+
+    SECTION("stopped pool")
+    {
+        pool.request_stop();
+
+        auto values = lines | Parallel::par_collect(record_values, pool);
+
+        CHECK(std::ranges::equal(values, expected_values));
+    }
+}
+
+TEST_CASE("par_collect - scaling of the split pipeline", "[.][benchmark]")
+{
+    const std::string buffer = create_key_value_lines(4'000'000);
+    std::vector<std::string_view> lines;
+    for (size_t pos = 0; pos < buffer.size();)
+    {
+        const auto eol = buffer.find('\n', pos);
+        lines.emplace_back(buffer.data() + pos, eol - pos);
+        pos = eol + 1;
+    }
+
+    auto report = [&](std::string_view name, size_t no_of_threads, auto collect) {
+        constexpr int no_of_runs = 5;
+        std::chrono::duration<double> best{std::chrono::hours{1}};
+        size_t no_of_values = 0;
+
+        for (int run = 0; run < no_of_runs; ++run)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            no_of_values = collect().size();
+            best = std::min<std::chrono::duration<double>>(best, std::chrono::steady_clock::now() - start);
+        }
+
+        std::cout << name << " - " << no_of_threads << " thread(s): " << static_cast<long long>(lines.size() / best.count()) << " lines/s ("
+                  << no_of_values << " values)\n";
+    };
+
+    report("sequential", 1, [&] {
+        auto values = lines | record_values;
+        return std::vector<std::string_view>(values.begin(), values.end());
+    });
+
+    for (size_t no_of_threads = 1; no_of_threads <= std::max(4u, std::thread::hardware_concurrency()); no_of_threads *= 2)
+    {
+        Concurrency::ThreadPool pool{no_of_threads};
+
+        report("par_collect", no_of_threads, [&] { return lines | Parallel::par_collect(record_values, pool); });
+        report("par_collect (unordered)", no_of_threads,
+            [&] { return lines | Parallel::par_collect(record_values, pool, {.order = Parallel::Order::unordered}); });
+    }
+
+    TempFile file{"par_collect_benchmark.txt"};
+    file.write(buffer);
+    Views::mapped_lines_view mapped_lines{file.path()};
+
+    for (size_t no_of_threads = 1; no_of_threads <= std::max(4u, std::thread::hardware_concurrency()); no_of_threads *= 2)
+    {
+        Concurrency::ThreadPool pool{no_of_threads};
+
+        report("par_collect (mapped_lines_view)", no_of_threads, [&] { return mapped_lines | Parallel::par_collect(record_values, pool); });
+    }
+}
@@ -0,0 +1,364 @@
+#ifndef SIMD_SEARCH_HPP
+#define SIMD_SEARCH_HPP
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <ranges>
+#include <type_traits>
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#define SIMD_SEARCH_X86 1
+#else
+#define SIMD_SEARCH_X86 0
+#endif
+
+// reading past the end of a range (within a page) is reported by AddressSanitizer & ThreadSanitizer
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+#define SIMD_SEARCH_ALLOW_OVERREAD 0
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer) || __has_feature(thread_sanitizer)
+#define SIMD_SEARCH_ALLOW_OVERREAD 0
+#endif
+#endif
+#ifndef SIMD_SEARCH_ALLOW_OVERREAD
+#define SIMD_SEARCH_ALLOW_OVERREAD 1
+#endif
+
+namespace Search
+{
+    ///////////////////////////////////////////////////////////////////////
+    // Vectorized find / count / find_if(equal_to(value)) for contiguous ranges of integers
+    //  - selected by concepts: contiguous iterator + integral element (not bool) + x86 SIMD available,
+    //    every other combination falls back to std::ranges algorithms
+    //  - bounded ranges: 4 blocks per iteration, scalar tail
+    //  - with std::unreachable_sentinel (precondition: the value is in the range) there is no tail
+    //    and no bounds check: aligned loads never cross a page boundary, so reading
+    //    up to the end of the (group of) block(s) containing the match is safe
+
+    template <typename T>
+    struct EqualTo
+    {
+        T value;
+
+        template <typename U>
+        constexpr bool operator()(const U& item) const
+        {
+            return item == value;
+        }
+    };
+
+    template <typename T>
+    constexpr EqualTo<T> equal_to(T value)
+    {
+        return {value};
+    }
+
+    namespace Detail
+    {
+#if SIMD_SEARCH_X86
+#if defined(__AVX2__)
+        using Block = __m256i;
+
+        inline Block load(const void* p) noexcept { return _mm256_load_si256(static_cast<const Block*>(p)); }
+        inline Block loadu(const void* p) noexcept { return _mm256_loadu_si256(static_cast<const Block*>(p)); }
+        inline uint32_t byte_mask(Block b) noexcept { return static_cast<uint32_t>(_mm256_movemask_epi8(b)); }
+        inline Block bit_or(Block a, Block b) noexcept { return _mm256_or_si256(a, b); }
+        inline Block zero() noexcept { return _mm256_setzero_si256(); }
+
+        template <size_t Size>
+        Block splat(uint64_t value) noexcept
+        {
+            if constexpr (Size == 1) return _mm256_set1_epi8(static_cast<char>(value));
+            else if constexpr (Size == 2) return _mm256_set1_epi16(static_cast<short>(value));
+            else if constexpr (Size == 4) return _mm256_set1_epi32(static_cast<int>(value));
+            else return _mm256_set1_epi64x(static_cast<long long>(value));
+        }
+
+        template <size_t Size>
+        Block equal(Block a, Block b) noexcept
+        {
+            if constexpr (Size == 1) return _mm256_cmpeq_epi8(a, b);
+            else if constexpr (Size == 2) return _mm256_cmpeq_epi16(a, b);
+            else if constexpr (Size == 4) return _mm256_cmpeq_epi32(a, b);
+            else return _mm256_cmpeq_epi64(a, b);
+        }
+
+        // lane-wise acc - mask: a matching lane (all ones == -1) adds 1
+        template <size_t Size>
+        Block add_matches(Block acc, Block mask) noexcept
+        {
+            if constexpr (Size == 1) return _mm256_sub_epi8(acc, mask);
+            else if constexpr (Size == 2) return _mm256_sub_epi16(acc, mask);
+            else if constexpr (Size == 4) return _mm256_sub_epi32(acc, mask);
+            else return _mm256_sub_epi64(acc, mask);
+        }
+
+        inline void store(void* p, Block b) noexcept { _mm256_storeu_si256(static_cast<Block*>(p), b); }
+#else
+        using Block = __m128i;
+
+        inline Block load(const void* p) noexcept { return _mm_load_si128(static_cast<const Block*>(p)); }
+        inline Block loadu(const void* p) noexcept { return _mm_loadu_si128(static_cast<const Block*>(p)); }
+        inline uint32_t byte_mask(Block b) noexcept { return static_cast<uint32_t>(_mm_movemask_epi8(b)); }
+        inline Block bit_or(Block a, Block b) noexcept { return _mm_or_si128(a, b); }
+        inline Block zero() noexcept { return _mm_setzero_si128(); }
+
+        template <size_t Size>
+        Block splat(uint64_t value) noexcept
+        {
+            if constexpr (Size == 1) return _mm_set1_epi8(static_cast<char>(value));
+            else if constexpr (Size == 2) return _mm_set1_epi16(static_cast<short>(value));
+            else if constexpr (Size == 4) return _mm_set1_epi32(static_cast<int>(value));
+            else return _mm_set1_epi64x(static_cast<long long>(value));
+        }
+
+        template <size_t Size>
+        Block equal(Block a, Block b) noexcept
+        {
+            if constexpr (Size == 1) return _mm_cmpeq_epi8(a, b);
+            else if constexpr (Size == 2) return _mm_cmpeq_epi16(a, b);
+            else if constexpr (Size == 4) return _mm_cmpeq_epi32(a, b);
+            else
+            {
+                // SSE2 has no 64-bit compare: both 32-bit halves must be equal
+                const Block halves = _mm_cmpeq_epi32(a, b);
+                return _mm_and_si128(halves, _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1)));
+            }
+        }
+
+        template <size_t Size>
+        Block add_matches(Block acc, Block mask) noexcept
+        {
+            if constexpr (Size == 1) return _mm_sub_epi8(acc, mask);
+            else if constexpr (Size == 2) return _mm_sub_epi16(acc, mask);
+            else if constexpr (Size == 4) return _mm_sub_epi32(acc, mask);
+            else return _mm_sub_epi64(acc, mask);
+        }
+
+        inline void store(void* p, Block b) noexcept { _mm_storeu_si128(static_cast<Block*>(p), b); }
+#endif
+        inline constexpr size_t block_size = sizeof(Block);
+        inline constexpr bool has_simd = true;
+#else
+        inline constexpr bool has_simd = false;
+#endif
+
+        template <typename TElement>
+        concept SimdElement = has_simd && std::integral<TElement> && !std::same_as<TElement, bool>
+            && (sizeof(TElement) == 1 || sizeof(TElement) == 2 || sizeof(TElement) == 4 || sizeof(TElement) == 8);
+
+        template <typename TIterator>
+        concept SimdIterator = std::contiguous_iterator<TIterator> && SimdElement<std::remove_cv_t<std::iter_value_t<TIterator>>>;
+
+        // value converted to the element type compares equal exactly like the original one
+        template <typename TElement, typename T>
+        bool is_representable(const T& value, TElement& converted)
+        {
+            if constexpr (std::integral<T> && !std::same_as<T, bool>)
+            {
+                converted = static_cast<TElement>(value);
+                return static_cast<T>(converted) == value && ((converted < TElement{}) == (value < T{}));
+            }
+            else
+                return false;
+        }
+
+#if SIMD_SEARCH_X86
+        template <typename TElement>
+        const TElement* find(const TElement* first, const TElement* last, TElement value) noexcept
+        {
+            constexpr size_t per_block = block_size / sizeof(TElement);
+            const Block needle = splat<sizeof(TElement)>(static_cast<uint64_t>(value));
+
+            auto index_in_block = [](uint32_t mask) { return std::countr_zero(mask) / sizeof(TElement); };
+
+            for (; last - first >= static_cast<std::ptrdiff_t>(4 * per_block); first += 4 * per_block)
+            {
+                const Block m0 = equal<sizeof(TElement)>(loadu(first), needle);
+                const Block m1 = equal<sizeof(TElement)>(loadu(first + per_block), needle);
+                const Block m2 = equal<sizeof(TElement)>(loadu(first + 2 * per_block), needle);
+                const Block m3 = equal<sizeof(TElement)>(loadu(first + 3 * per_block), needle);
+
+                if (byte_mask(bit_or(bit_or(m0, m1), bit_or(m2, m3))) == 0)
+                    continue;
+
+                const Block masks[] = {m0, m1, m2, m3};
+                for (size_t i = 0; i < 4; ++i)
+                    if (const uint32_t mask = byte_mask(masks[i]))
+                        return first + i * per_block + index_in_block(mask);
+            }
+
+            for (; last - first >= static_cast<std::ptrdiff_t>(per_block); first += per_block)
+                if (const uint32_t mask = byte_mask(equal<sizeof(TElement)>(loadu(first), needle)))
+                    return first + index_in_block(mask);
+
+            return std::find(first, last, value);
+        }
+
+        template <typename TElement>
+        const TElement* find_unbounded(const TElement* first, TElement value) noexcept
+        {
+            constexpr size_t per_block = block_size / sizeof(TElement);
+            const Block needle = splat<sizeof(TElement)>(static_cast<uint64_t>(value));
+
+            // the first (aligned) block may start before first - matches in front of it are masked out
+            const auto address = reinterpret_cast<uintptr_t>(first);
+            const TElement* block = reinterpret_cast<const TElement*>(address & ~uintptr_t{block_size - 1});
+            const uint32_t skipped_bytes = static_cast<uint32_t>(address - reinterpret_cast<uintptr_t>(block));
+
+            uint32_t mask = byte_mask(equal<sizeof(TElement)>(load(block), needle)) >> skipped_bytes << skipped_bytes;
+
+            // single blocks up to a group of 4 blocks - an aligned group never crosses a page boundary either
+            constexpr uintptr_t group_size = 4 * block_size;
+            while (mask == 0 && reinterpret_cast<uintptr_t>(block + per_block) % group_size != 0)
+            {
+                block += per_block;
+                mask = byte_mask(equal<sizeof(TElement)>(load(block), needle));
+            }
+
+            if (mask != 0)
+                return block + std::countr_zero(mask) / sizeof(TElement);
+
+            for (block += per_block;; block += 4 * per_block)
+            {
+                const Block m0 = equal<sizeof(TElement)>(load(block), needle);
+                const Block m1 = equal<sizeof(TElement)>(load(block + per_block), needle);
+                const Block m2 = equal<sizeof(TElement)>(load(block + 2 * per_block), needle);
+                const Block m3 = equal<sizeof(TElement)>(load(block + 3 * per_block), needle);
+
+                if (byte_mask(bit_or(bit_or(m0, m1), bit_or(m2, m3))) == 0)
+                    continue;
+
+                const Block masks[] = {m0, m1, m2, m3};
+                for (size_t i = 0; i < 4; ++i)
+                    if (const uint32_t mask = byte_mask(masks[i]))
+                        return block + i * per_block + std::countr_zero(mask) / sizeof(TElement);
+            }
+        }
+
+        template <typename TElement>
+        std::ptrdiff_t count(const TElement* first, const TElement* last, TElement value) noexcept
+        {
+            using Lane = std::conditional_t<sizeof(TElement) == 1, uint8_t,
+                std::conditional_t<sizeof(TElement) == 2, uint16_t,
+                    std::conditional_t<sizeof(TElement) == 4, uint32_t, uint64_t>>>;
+
+            constexpr size_t per_block = block_size / sizeof(TElement);
+            constexpr size_t max_blocks_per_round = std::min<uint64_t>(std::numeric_limits<Lane>::max(), uint64_t{1} << 30); // no lane overflow
+            const Block needle = splat<sizeof(TElement)>(static_cast<uint64_t>(value));
+
+            std::ptrdiff_t result = 0;
+            size_t no_of_blocks = static_cast<size_t>(last - first) / per_block;
+
+            while (no_of_blocks > 0)
+            {
+                const size_t round = std::min(no_of_blocks, max_blocks_per_round);
+                Block acc = zero();
+                for (size_t i = 0; i < round; ++i, first += per_block)
+                    acc = add_matches<sizeof(TElement)>(acc, equal<sizeof(TElement)>(loadu(first), needle));
+                no_of_blocks -= round;
+
+                Lane lanes[per_block];
+                store(lanes, acc);
+                for (Lane lane : lanes)
+                    result += static_cast<std::ptrdiff_t>(lane);
+            }
+
+            return result + std::count(first, last, value);
+        }
+#else
+        // never instantiated - SimdIterator is not satisfied without SIMD
+        template <typename TElement>
+        const TElement* find(const TElement* first, const TElement* last, TElement value) noexcept;
+
+        template <typename TElement>
+        const TElement* find_unbounded(const TElement* first, TElement value) noexcept;
+
+        template <typename TElement>
+        std::ptrdiff_t count(const TElement* first, const TElement* last, TElement value) noexcept;
+#endif
+    } // namespace Detail
+
+    template <std::input_iterator TIterator, std::sentinel_for<TIterator> TSentinel, typename T>
+    TIterator find(TIterator first, TSentinel last, const T& value)
+    {
+        using Element = std::remove_cv_t<std::iter_value_t<TIterator>>;
+
+        if constexpr (Detail::SimdIterator<TIterator>)
+        {
+            Element needle;
+            if (Detail::is_representable(value, needle))
+            {
+                const Element* data = std::to_address(first);
+
+                if constexpr (std::same_as<TSentinel, std::unreachable_sentinel_t>)
+                {
+                    if constexpr (SIMD_SEARCH_ALLOW_OVERREAD)
+                        return first + (Detail::find_unbounded(data, needle) - data);
+                }
+                else if constexpr (std::sized_sentinel_for<TSentinel, TIterator>)
+                    return first + (Detail::find(data, data + (last - first), needle) - data);
+            }
+        }
+
+        return std::ranges::find(first, last, value);
+    }
+
+    template <std::ranges::input_range TRange, typename T>
+    std::ranges::borrowed_iterator_t<TRange> find(TRange&& rng, const T& value)
+    {
+        return Search::find(std::ranges::begin(rng), std::ranges::end(rng), value);
+    }
+
+    template <std::input_iterator TIterator, std::sentinel_for<TIterator> TSentinel, typename T>
+    std::iter_difference_t<TIterator> count(TIterator first, TSentinel last, const T& value)
+    {
+        using Element = std::remove_cv_t<std::iter_value_t<TIterator>>;
+
+        if constexpr (Detail::SimdIterator<TIterator> && std::sized_sentinel_for<TSentinel, TIterator>)
+        {
+            Element needle;
+            if (Detail::is_representable(value, needle))
+            {
+                const Element* data = std::to_address(first);
+                return Detail::count(data, data + (last - first), needle);
+            }
+        }
+
+        return std::ranges::count(first, last, value);
+    }
+
+    template <std::ranges::input_range TRange, typename T>
+    std::ranges::range_difference_t<TRange> count(TRange&& rng, const T& value)
+    {
+        return Search::count(std::ranges::begin(rng), std::ranges::end(rng), value);
+    }
+
+    template <std::input_iterator TIterator, std::sentinel_for<TIterator> TSentinel, typename TPredicate>
+    TIterator find_if(TIterator first, TSentinel last, TPredicate pred)
+    {
+        return std::ranges::find_if(first, last, std::ref(pred));
+    }
+
+    template <std::input_iterator TIterator, std::sentinel_for<TIterator> TSentinel, typename T>
+    TIterator find_if(TIterator first, TSentinel last, EqualTo<T> pred)
+    {
+        return Search::find(first, last, pred.value);
+    }
+
+    template <std::ranges::input_range TRange, typename TPredicate>
+    std::ranges::borrowed_iterator_t<TRange> find_if(TRange&& rng, TPredicate pred)
+    {
+        return Search::find_if(std::ranges::begin(rng), std::ranges::end(rng), pred);
+    }
+} // namespace Search
+
+#endif // SIMD_SEARCH_HPP
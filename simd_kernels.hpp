@@ -0,0 +1,194 @@
+#ifndef SIMD_KERNELS_HPP
+#define SIMD_KERNELS_HPP
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iterator>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#define SIMD_KERNELS_X86 1
+#else
+#define SIMD_KERNELS_X86 0
+#endif
+
+namespace Kernels
+{
+    ///////////////////////////////////////////////////////////////////////
+    // Building blocks shared by the reductions of the modules
+    //  - SimdOps<T> - lanes of T (float, double: AVX or SSE2; 32/64-bit integers: AVX2 or SSE2)
+    //  - load_as_doubles - lanes of doubles converted from double, float or int32 items
+    //  - parallel_chunk_results - splits a random-access range between threads;
+    //    exceptions thrown by the chunks are rethrown in the calling thread (the first one in chunk order)
+    //  - parallel_reduce - combines the chunk results in order with +
+
+    inline constexpr size_t parallel_threshold = 4 * 1024 * 1024;
+
+    // one chunk per parallel_threshold / 4 items, at most one per hardware thread
+    inline size_t default_no_of_chunks(size_t size)
+    {
+        return std::clamp<size_t>(size / (parallel_threshold / 4), 1, std::max(1u, std::thread::hardware_concurrency()));
+    }
+
+    template <typename T>
+    struct SimdOps; // no specialization - not vectorized
+
+#if SIMD_KERNELS_X86
+#if defined(__AVX__)
+    template <>
+    struct SimdOps<float>
+    {
+        using Vector = __m256;
+        static Vector zero() noexcept { return _mm256_setzero_ps(); }
+        static Vector load(const float* p) noexcept { return _mm256_loadu_ps(p); }
+        static Vector add(Vector a, Vector b) noexcept { return _mm256_add_ps(a, b); }
+        static Vector sub(Vector a, Vector b) noexcept { return _mm256_sub_ps(a, b); }
+        static void store(float* p, Vector v) noexcept { _mm256_storeu_ps(p, v); }
+    };
+
+    template <>
+    struct SimdOps<double>
+    {
+        using Vector = __m256d;
+        static Vector zero() noexcept { return _mm256_setzero_pd(); }
+        static Vector load(const double* p) noexcept { return _mm256_loadu_pd(p); }
+        static Vector add(Vector a, Vector b) noexcept { return _mm256_add_pd(a, b); }
+        static Vector sub(Vector a, Vector b) noexcept { return _mm256_sub_pd(a, b); }
+        static void store(double* p, Vector v) noexcept { _mm256_storeu_pd(p, v); }
+    };
+
+    inline __m256d load_as_doubles(const double* p) noexcept { return _mm256_loadu_pd(p); }
+    inline __m256d load_as_doubles(const float* p) noexcept { return _mm256_cvtps_pd(_mm_loadu_ps(p)); }
+    inline __m256d load_as_doubles(const int32_t* p) noexcept { return _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))); }
+#else
+    template <>
+    struct SimdOps<float>
+    {
+        using Vector = __m128;
+        static Vector zero() noexcept { return _mm_setzero_ps(); }
+        static Vector load(const float* p) noexcept { return _mm_loadu_ps(p); }
+        static Vector add(Vector a, Vector b) noexcept { return _mm_add_ps(a, b); }
+        static Vector sub(Vector a, Vector b) noexcept { return _mm_sub_ps(a, b); }
+        static void store(float* p, Vector v) noexcept { _mm_storeu_ps(p, v); }
+    };
+
+    template <>
+    struct SimdOps<double>
+    {
+        using Vector = __m128d;
+        static Vector zero() noexcept { return _mm_setzero_pd(); }
+        static Vector load(const double* p) noexcept { return _mm_loadu_pd(p); }
+        static Vector add(Vector a, Vector b) noexcept { return _mm_add_pd(a, b); }
+        static Vector sub(Vector a, Vector b) noexcept { return _mm_sub_pd(a, b); }
+        static void store(double* p, Vector v) noexcept { _mm_storeu_pd(p, v); }
+    };
+
+    inline __m128d load_as_doubles(const double* p) noexcept { return _mm_loadu_pd(p); }
+    inline __m128d load_as_doubles(const float* p) noexcept { return _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)))); }
+    inline __m128d load_as_doubles(const int32_t* p) noexcept { return _mm_cvtepi32_pd(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p))); }
+#endif
+
+    template <std::integral T>
+        requires(sizeof(T) == 4 || sizeof(T) == 8) && (!std::same_as<T, bool>)
+    struct SimdOps<T>
+    {
+#if defined(__AVX2__)
+        using Vector = __m256i;
+        static Vector zero() noexcept { return _mm256_setzero_si256(); }
+        static Vector load(const T* p) noexcept { return _mm256_loadu_si256(reinterpret_cast<const Vector*>(p)); }
+        static void store(T* p, Vector v) noexcept { _mm256_storeu_si256(reinterpret_cast<Vector*>(p), v); }
+
+        static Vector add(Vector a, Vector b) noexcept
+        {
+            if constexpr (sizeof(T) == 4)
+                return _mm256_add_epi32(a, b);
+            else
+                return _mm256_add_epi64(a, b);
+        }
+#else
+        using Vector = __m128i;
+        static Vector zero() noexcept { return _mm_setzero_si128(); }
+        static Vector load(const T* p) noexcept { return _mm_loadu_si128(reinterpret_cast<const Vector*>(p)); }
+        static void store(T* p, Vector v) noexcept { _mm_storeu_si128(reinterpret_cast<Vector*>(p), v); }
+
+        static Vector add(Vector a, Vector b) noexcept
+        {
+            if constexpr (sizeof(T) == 4)
+                return _mm_add_epi32(a, b);
+            else
+                return _mm_add_epi64(a, b);
+        }
+#endif
+    };
+#endif
+
+    template <typename T>
+    concept SimdVectorizable = requires { typename SimdOps<std::remove_cv_t<T>>::Vector; };
+
+    // number of T items in a vector of SimdOps<T>
+    template <SimdVectorizable T>
+    inline constexpr size_t lanes_of = sizeof(typename SimdOps<std::remove_cv_t<T>>::Vector) / sizeof(T);
+
+    template <std::random_access_iterator TIterator, typename TReduceChunk>
+    auto parallel_chunk_results(TIterator first, size_t size, TReduceChunk reduce_chunk, size_t no_of_chunks)
+    {
+        using Result = decltype(reduce_chunk(first, size));
+
+        no_of_chunks = std::clamp<size_t>(no_of_chunks, 1, std::max<size_t>(size, 1));
+        std::vector<Result> results(no_of_chunks);
+        std::vector<std::exception_ptr> errors(no_of_chunks);
+
+        auto reduce = [&](size_t chunk) {
+            const size_t begin = size * chunk / no_of_chunks;
+            const size_t end = size * (chunk + 1) / no_of_chunks;
+            try
+            {
+                results[chunk] = reduce_chunk(first + begin, end - begin);
+            }
+            catch (...)
+            {
+                errors[chunk] = std::current_exception();
+            }
+        };
+
+        {
+            std::vector<std::jthread> threads;
+            for (size_t chunk = 1; chunk < no_of_chunks; ++chunk)
+                threads.emplace_back(reduce, chunk);
+            reduce(0); // the first chunk is reduced by the calling thread
+        }
+
+        for (const auto& error : errors)
+            if (error)
+                std::rethrow_exception(error);
+
+        return results;
+    }
+
+    // the operation must be associative (like for std::reduce)
+    template <std::random_access_iterator TIterator, typename TReduceChunk>
+    auto parallel_reduce(TIterator first, size_t size, TReduceChunk reduce_chunk, size_t no_of_chunks)
+    {
+        auto results = parallel_chunk_results(first, size, reduce_chunk, no_of_chunks);
+
+        auto result = std::move(results[0]);
+        for (size_t chunk = 1; chunk < results.size(); ++chunk)
+            result = std::move(result) + std::move(results[chunk]);
+        return result;
+    }
+
+    template <std::random_access_iterator TIterator, typename TReduceChunk>
+    auto parallel_reduce(TIterator first, size_t size, TReduceChunk reduce_chunk)
+    {
+        return parallel_reduce(first, size, reduce_chunk, default_no_of_chunks(size));
+    }
+} // namespace Kernels
+
+#endif // SIMD_KERNELS_HPP
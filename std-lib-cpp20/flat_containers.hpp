@@ -0,0 +1,252 @@
+#ifndef FLAT_CONTAINERS_HPP
+#define FLAT_CONTAINERS_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <ranges>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace Containers
+{
+    ///////////////////////////////////////////////////////////////////////
+    // flat_set & flat_map - sorted unique items in one std::vector
+    //  - lookups are binary searches over contiguous memory - no per-node allocations & pointer chasing
+    //  - insert(value) shifts the tail: O(n) - fine for small containers or occasional inserts
+    //  - insert_range(rng) - bulk insert: the items are appended, the new part is sorted & merged
+    //    with the old one in place - O(n + k log k) for k new items
+    //  - like std::set/std::map, an item equivalent to one already stored is not inserted
+    //  - any insert or erase invalidates iterators & references
+
+    namespace Detail
+    {
+        struct Identity
+        {
+            template <typename T>
+            constexpr const T& operator()(const T& value) const noexcept
+            {
+                return value;
+            }
+        };
+
+        struct First
+        {
+            template <typename TPair>
+            constexpr const auto& operator()(const TPair& pair) const noexcept
+            {
+                return pair.first;
+            }
+        };
+
+        template <typename TValue, typename TKey, typename TKeyOf, typename TCompare>
+        class FlatSorted
+        {
+        public:
+            using key_type = TKey;
+            using value_type = TValue;
+            using key_compare = TCompare;
+            using size_type = size_t;
+            using container_type = std::vector<TValue>;
+            using iterator = typename container_type::iterator;
+            using const_iterator = typename container_type::const_iterator;
+
+            FlatSorted() = default;
+
+            explicit FlatSorted(const TCompare& compare)
+                : compare_{compare}
+            {
+            }
+
+            const_iterator begin() const noexcept { return items_.begin(); }
+            const_iterator end() const noexcept { return items_.end(); }
+            size_t size() const noexcept { return items_.size(); }
+            bool empty() const noexcept { return items_.empty(); }
+            void reserve(size_t capacity) { items_.reserve(capacity); }
+            void clear() noexcept { items_.clear(); }
+
+            std::pair<const_iterator, bool> insert(const TValue& value)
+            {
+                return emplace_at(TKeyOf{}(value), value);
+            }
+
+            std::pair<const_iterator, bool> insert(TValue&& value)
+            {
+                return emplace_at(TKeyOf{}(value), std::move(value));
+            }
+
+            template <std::ranges::input_range TRange>
+            void insert_range(TRange&& rng)
+            {
+                const size_t old_size = items_.size();
+
+                if constexpr (std::ranges::sized_range<TRange>)
+                    items_.reserve(old_size + std::ranges::size(rng));
+                for (auto&& item : rng)
+                    items_.emplace_back(std::forward<decltype(item)>(item));
+
+                const auto middle = items_.begin() + old_size;
+
+                // stable - the first of equivalent new items wins
+                std::stable_sort(middle, items_.end(), value_compare());
+                items_.erase(std::unique(middle, items_.end(), value_equivalent()), items_.end());
+
+                if (old_size == 0 || middle == items_.end())
+                    return;
+
+                if (value_compare()(*middle, *std::prev(middle))) // the key ranges overlap
+                {
+                    // stable - the old items precede equivalent new ones & win
+                    std::inplace_merge(items_.begin(), middle, items_.end(), value_compare());
+                    items_.erase(std::unique(items_.begin(), items_.end(), value_equivalent()), items_.end());
+                }
+                else if (!value_compare()(*std::prev(middle), *middle)) // the first new item is the last old one
+                    items_.erase(middle);
+            }
+
+            size_t erase(const TKey& key)
+            {
+                const auto it = find_mutable(key);
+                if (it == items_.end())
+                    return 0;
+                items_.erase(it);
+                return 1;
+            }
+
+            const_iterator erase(const_iterator pos)
+            {
+                return items_.erase(pos);
+            }
+
+            const_iterator lower_bound(const TKey& key) const
+            {
+                return std::ranges::lower_bound(items_, key, compare_, TKeyOf{});
+            }
+
+            const_iterator upper_bound(const TKey& key) const
+            {
+                return std::ranges::upper_bound(items_, key, compare_, TKeyOf{});
+            }
+
+            const_iterator find(const TKey& key) const
+            {
+                const auto it = lower_bound(key);
+                return (it != items_.end() && !compare_(key, TKeyOf{}(*it))) ? it : items_.end();
+            }
+
+            bool contains(const TKey& key) const
+            {
+                return find(key) != items_.end();
+            }
+
+            size_t count(const TKey& key) const
+            {
+                return contains(key) ? 1 : 0;
+            }
+
+            bool operator==(const FlatSorted& other) const
+            {
+                return items_ == other.items_;
+            }
+
+        protected:
+            container_type items_;
+            [[no_unique_address]] TCompare compare_;
+
+            auto value_compare() const
+            {
+                return [this](const TValue& a, const TValue& b) { return compare_(TKeyOf{}(a), TKeyOf{}(b)); };
+            }
+
+            auto value_equivalent() const
+            {
+                return [this](const TValue& a, const TValue& b) { return !compare_(TKeyOf{}(a), TKeyOf{}(b)) && !compare_(TKeyOf{}(b), TKeyOf{}(a)); };
+            }
+
+            iterator find_mutable(const TKey& key)
+            {
+                const auto it = std::ranges::lower_bound(items_, key, compare_, TKeyOf{});
+                return (it != items_.end() && !compare_(key, TKeyOf{}(*it))) ? it : items_.end();
+            }
+
+            template <typename TArg>
+            std::pair<iterator, bool> emplace_at(const TKey& key, TArg&& value)
+            {
+                const auto it = std::ranges::lower_bound(items_, key, compare_, TKeyOf{});
+                if (it != items_.end() && !compare_(key, TKeyOf{}(*it)))
+                    return {it, false};
+                return {items_.insert(it, std::forward<TArg>(value)), true};
+            }
+        };
+    } // namespace Detail
+
+    template <typename TKey, typename TCompare = std::less<TKey>>
+    class flat_set : public Detail::FlatSorted<TKey, TKey, Detail::Identity, TCompare>
+    {
+        using Base = Detail::FlatSorted<TKey, TKey, Detail::Identity, TCompare>;
+
+    public:
+        using iterator = typename Base::const_iterator; // keys are immutable
+
+        using Base::Base;
+
+        flat_set(std::initializer_list<TKey> items, const TCompare& compare = TCompare{})
+            : Base{compare}
+        {
+            this->insert_range(items);
+        }
+    };
+
+    // items are std::pair<TKey, T> - keys must not be modified through iterators
+    template <typename TKey, typename T, typename TCompare = std::less<TKey>>
+    class flat_map : public Detail::FlatSorted<std::pair<TKey, T>, TKey, Detail::First, TCompare>
+    {
+        using Base = Detail::FlatSorted<std::pair<TKey, T>, TKey, Detail::First, TCompare>;
+
+    public:
+        using mapped_type = T;
+        using typename Base::iterator;
+
+        using Base::Base;
+
+        flat_map(std::initializer_list<std::pair<TKey, T>> items, const TCompare& compare = TCompare{})
+            : Base{compare}
+        {
+            this->insert_range(items);
+        }
+
+        iterator begin() noexcept { return this->items_.begin(); }
+        iterator end() noexcept { return this->items_.end(); }
+        using Base::begin;
+        using Base::end;
+
+        T& operator[](const TKey& key)
+        {
+            auto it = std::ranges::lower_bound(this->items_, key, this->compare_, Detail::First{});
+            if (it == this->items_.end() || this->compare_(key, it->first))
+                it = this->items_.emplace(it, key, T{});
+            return it->second;
+        }
+
+        T& at(const TKey& key)
+        {
+            const auto it = this->find_mutable(key);
+            if (it == this->items_.end())
+                throw std::out_of_range("flat_map::at - key not found");
+            return it->second;
+        }
+
+        const T& at(const TKey& key) const
+        {
+            const auto it = this->find(key);
+            if (it == this->items_.end())
+                throw std::out_of_range("flat_map::at - key not found");
+            return it->second;
+        }
+    };
+} // namespace Containers
+
+#endif // FLAT_CONTAINERS_HPP
@@ -0,0 +1,230 @@
+#ifndef REDUCTIONS_HPP
+#define REDUCTIONS_HPP
+
+#include "../simd_kernels.hpp"
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+namespace Reductions
+{
+    ///////////////////////////////////////////////////////////////////////
+    // Summing spans of numbers into a double
+    //  - fast: 4 independent SIMD accumulators of doubles (AVX: 4 x 4 lanes, SSE2: 4 x 2 lanes)
+    //    for int32/float/double, 8 scalar accumulators for other arithmetic types
+    //  - kahan: the same lanes with Kahan compensation - error independent of the size
+    //  - pairwise: recursive halving down to blocks summed with the fast kernel - O(log n) error growth
+    //  - fixed extents up to unrolled_extent_limit are summed by an unrolled fold expression
+    //  - dynamic spans of parallel_threshold+ items are split between threads (Kernels::parallel_chunk_results)
+    //    (the result may differ in the last bits depending on the number of threads)
+
+    enum class Summation
+    {
+        fast,
+        kahan,
+        pairwise
+    };
+
+    inline constexpr size_t unrolled_extent_limit = 32;
+    inline constexpr size_t parallel_threshold = Kernels::parallel_threshold;
+
+    namespace Detail
+    {
+        struct KahanSum
+        {
+            double sum = 0.0;
+            double compensation = 0.0;
+
+            void add(double value) noexcept
+            {
+                const double y = value - compensation;
+                const double t = sum + y;
+                compensation = (t - sum) - y;
+                sum = t;
+            }
+        };
+
+#if SIMD_KERNELS_X86
+        using DoubleOps = Kernels::SimdOps<double>;
+        using Lanes = DoubleOps::Vector;
+        inline constexpr size_t lanes_count = Kernels::lanes_of<double>;
+
+        // items loaded with Kernels::load_as_doubles
+        template <typename T>
+        concept SimdSummable = std::same_as<T, double> || std::same_as<T, float> || (std::same_as<T, int32_t> && sizeof(int) == 4);
+#else
+        template <typename T>
+        concept SimdSummable = false;
+#endif
+
+        template <Summation Mode, typename T>
+        double sum_scalar(const T* first, size_t size)
+        {
+            constexpr size_t no_of_accumulators = 8;
+
+            if constexpr (Mode == Summation::kahan)
+            {
+                std::array<KahanSum, no_of_accumulators> accumulators{};
+                size_t i = 0;
+                for (; i + no_of_accumulators <= size; i += no_of_accumulators)
+                    for (size_t j = 0; j < no_of_accumulators; ++j)
+                        accumulators[j].add(static_cast<double>(first[i + j]));
+
+                KahanSum total;
+                for (const auto& acc : accumulators)
+                {
+                    total.add(acc.sum);
+                    total.add(-acc.compensation);
+                }
+                for (; i < size; ++i)
+                    total.add(static_cast<double>(first[i]));
+
+                return total.sum;
+            }
+            else
+            {
+                std::array<double, no_of_accumulators> accumulators{};
+                size_t i = 0;
+                for (; i + no_of_accumulators <= size; i += no_of_accumulators)
+                    for (size_t j = 0; j < no_of_accumulators; ++j)
+                        accumulators[j] += static_cast<double>(first[i + j]);
+
+                double total = 0.0;
+                for (double acc : accumulators)
+                    total += acc;
+                for (; i < size; ++i)
+                    total += static_cast<double>(first[i]);
+
+                return total;
+            }
+        }
+
+#if SIMD_KERNELS_X86
+        template <Summation Mode, typename T>
+        double sum_simd(const T* first, size_t size)
+        {
+            constexpr size_t no_of_accumulators = 4;
+            constexpr size_t step = no_of_accumulators * lanes_count;
+
+            Lanes sums[no_of_accumulators] = {DoubleOps::zero(), DoubleOps::zero(), DoubleOps::zero(), DoubleOps::zero()};
+            Lanes compensations[no_of_accumulators] = {DoubleOps::zero(), DoubleOps::zero(), DoubleOps::zero(), DoubleOps::zero()};
+
+            auto accumulate = [&](size_t j, const T* block) {
+                const Lanes values = Kernels::load_as_doubles(block + j * lanes_count);
+
+                if constexpr (Mode == Summation::kahan)
+                {
+                    const Lanes y = DoubleOps::sub(values, compensations[j]);
+                    const Lanes t = DoubleOps::add(sums[j], y);
+                    compensations[j] = DoubleOps::sub(DoubleOps::sub(t, sums[j]), y);
+                    sums[j] = t;
+                }
+                else
+                    sums[j] = DoubleOps::add(sums[j], values);
+            };
+
+            size_t i = 0;
+            for (; i + step <= size; i += step)
+            {
+                // unrolled by hand - otherwise the accumulators are kept in memory (gcc -O2)
+                accumulate(0, first + i);
+                accumulate(1, first + i);
+                accumulate(2, first + i);
+                accumulate(3, first + i);
+            }
+
+            KahanSum total;
+            for (size_t j = 0; j < no_of_accumulators; ++j)
+            {
+                double lane_sums[lanes_count];
+                double lane_compensations[lanes_count];
+                DoubleOps::store(lane_sums, sums[j]);
+                DoubleOps::store(lane_compensations, compensations[j]);
+
+                for (size_t lane = 0; lane < lanes_count; ++lane)
+                {
+                    total.add(lane_sums[lane]);
+                    total.add(-lane_compensations[lane]);
+                }
+            }
+
+            for (; i < size; ++i)
+                total.add(static_cast<double>(first[i]));
+
+            return total.sum;
+        }
+#endif
+
+        template <Summation Mode, typename T>
+        double sum_kernel(const T* first, size_t size)
+        {
+#if SIMD_KERNELS_X86
+            if constexpr (SimdSummable<std::remove_cv_t<T>>)
+                return sum_simd<Mode>(first, size);
+            else
+#endif
+                return sum_scalar<Mode>(first, size);
+        }
+
+        template <typename T>
+        double sum_pairwise(const T* first, size_t size)
+        {
+            constexpr size_t block_size = 4096;
+
+            if (size <= block_size)
+                return sum_kernel<Summation::fast>(first, size);
+
+            const size_t half = size / 2;
+            return sum_pairwise(first, half) + sum_pairwise(first + half, size - half);
+        }
+
+        template <Summation Mode, typename T>
+        double sum_sequential(const T* first, size_t size)
+        {
+            if constexpr (Mode == Summation::pairwise)
+                return sum_pairwise(first, size);
+            else
+                return sum_kernel<Mode>(first, size);
+        }
+
+        template <Summation Mode, typename T>
+        double sum_parallel(const T* first, size_t size)
+        {
+            const auto partial_sums = Kernels::parallel_chunk_results(
+                first, size, [](const T* chunk, size_t chunk_size) { return sum_sequential<Mode>(chunk, chunk_size); },
+                Kernels::default_no_of_chunks(size));
+
+            KahanSum total;
+            for (double partial_sum : partial_sums)
+                total.add(partial_sum);
+            return total.sum;
+        }
+    } // namespace Detail
+
+    template <Summation Mode = Summation::fast, typename T, size_t N>
+        requires std::is_arithmetic_v<T>
+    double sum_as_double(std::span<T, N> data)
+    {
+        if constexpr (N != std::dynamic_extent && N <= unrolled_extent_limit && Mode == Summation::fast)
+        {
+            return [&]<size_t... I>(std::index_sequence<I...>) {
+                return (0.0 + ... + static_cast<double>(data[I]));
+            }(std::make_index_sequence<N>{});
+        }
+        else
+        {
+            if constexpr (N == std::dynamic_extent)
+                if (data.size() >= parallel_threshold)
+                    return Detail::sum_parallel<Mode>(data.data(), data.size());
+
+            return Detail::sum_sequential<Mode>(data.data(), data.size());
+        }
+    }
+} // namespace Reductions
+
+#endif // REDUCTIONS_HPP
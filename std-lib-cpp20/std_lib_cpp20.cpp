@@ -1,26 +1,30 @@
 #include "../helpers.hpp"
+#include "flat_containers.hpp"
+#include "reductions.hpp"
 
 #include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
 #include <iostream>
+#include <limits>
+#include <list>
 #include <ranges>
 #include <span>
 #include <string>
 #include <vector>
 #include <bitset>
 #include <memory>
+#include <numeric>
 #include <array>
 #include <set>
 
 using namespace std::literals;
 
-template <typename T, size_t N>
+template <Reductions::Summation Mode = Reductions::Summation::fast, typename T, size_t N>
 double avg(std::span<T, N> data)
 {
-    double sum = 0.0;
-    for(const auto& item : data)
-        sum += item;
-    
-    return sum / data.size();
+    return Reductions::sum_as_double<Mode>(data) / data.size();
 }
 
 TEST_CASE("std::span")
@@ -61,6 +65,101 @@ TEST_CASE("std::span")
     }
 }
 
+TEST_CASE("avg - summation modes")
+{
+    using Reductions::Summation;
+
+    SECTION("fixed extent - unrolled")
+    {
+        const int data[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+        CHECK(avg(std::span{data}) == 5.5);
+        CHECK(avg<Summation::kahan>(std::span{data}) == 5.5);
+
+        const std::array<float, 3> floats = {0.5f, 1.5f, 2.5f};
+        CHECK(avg(std::span{floats}) == 1.5);
+    }
+
+    SECTION("dynamic extent - all paths agree on exact sums")
+    {
+        for (size_t size : {0ul, 1ul, 15ul, 16ul, 17ul, 1000ul, 4097ul, Reductions::parallel_threshold + 3})
+        {
+            std::vector<int> ints(size);
+            std::iota(ints.begin(), ints.end(), -static_cast<int>(size / 2));
+            const double expected = size ? std::accumulate(ints.begin(), ints.end(), 0.0) / size : 0.0;
+
+            for (double result : {avg(std::span{ints}), avg<Summation::kahan>(std::span{ints}), avg<Summation::pairwise>(std::span{ints})})
+            {
+                if (size == 0)
+                    CHECK(std::isnan(result));
+                else
+                    CHECK(result == expected);
+            }
+        }
+
+        const std::vector<short> shorts = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+        CHECK(avg(std::span{shorts}) == 6.0);
+        CHECK(avg<Summation::kahan>(std::span{shorts}) == 6.0);
+    }
+
+    SECTION("ill-conditioned data - kahan & pairwise are more accurate")
+    {
+        // 1.0 followed by 10M values too small to change it one by one
+        std::vector<double> data(10'000'001, 1e-16);
+        data[0] = 1.0;
+        const double exact_avg = (1.0 + 1e-9) / data.size();
+
+        auto error = [&](double result) { return std::abs(result - exact_avg) / exact_avg; };
+
+        double naive_sum = 0.0;
+        for (double item : data)
+            naive_sum += item;
+
+        CHECK(error(avg<Summation::kahan>(std::span{data})) < 1e-15);
+        CHECK(error(avg<Summation::pairwise>(std::span{data})) < 1e-12);
+        CHECK(error(naive_sum / data.size()) > 1e-10);
+    }
+}
+
+TEST_CASE("avg - elements/s - float & int32", "[.][benchmark]")
+{
+    using Reductions::Summation;
+
+    auto naive_avg = [](auto data) {
+        double sum = 0.0;
+        for (const auto& item : data)
+            sum += item;
+        return sum / data.size();
+    };
+
+    auto run = [&]<typename T>(std::string_view type_name, const std::vector<T>& data) {
+        const size_t no_of_runs = std::max<size_t>(1, 1'000'000'000 / data.size());
+
+        auto measure = [&](std::string_view name, auto average) {
+            const auto start = std::chrono::steady_clock::now();
+            double checksum = 0.0;
+            for (size_t run = 0; run < no_of_runs; ++run)
+                checksum += average(std::span{data});
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+            std::cout << std::setw(10) << data.size() << " " << type_name << " - " << std::setw(12) << std::left << name << std::right << ": "
+                      << std::setw(8) << std::fixed << std::setprecision(2) << data.size() * no_of_runs / elapsed.count() / 1e9
+                      << " G elements/s (" << std::defaultfloat << checksum / no_of_runs << ")\n";
+        };
+
+        measure("naive loop", naive_avg);
+        measure("fast", [](auto sp) { return avg(sp); });
+        measure("kahan", [](auto sp) { return avg<Summation::kahan>(sp); });
+        measure("pairwise", [](auto sp) { return avg<Summation::pairwise>(sp); });
+    };
+
+    for (size_t size : {1'000ul, 1'000'000ul, 64'000'000ul})
+    {
+        const std::vector<int> ints = Helpers::create_numeric_dataset(size, -1000, 1000, Helpers::DatasetOptions{});
+        run("int32", ints);
+        run("float", std::vector<float>(ints.begin(), ints.end()));
+    }
+}
+
 TEST_CASE("shallow constness")
 {
     std::array data = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
@@ -199,6 +298,130 @@ TEST_CASE("bit operations")
     append(mset, 42);
 }
 
+TEST_CASE("flat_set & flat_map")
+{
+    using Containers::flat_map;
+    using Containers::flat_set;
+
+    SECTION("append() dispatches to insert")
+    {
+        flat_set<int> fset = {5, 1, 3};
+
+        append(fset, 4);
+        append(fset, 1);
+
+        CHECK(std::ranges::equal(fset, std::vector{1, 3, 4, 5}));
+    }
+
+    SECTION("insert_range - appends, sorts & merges")
+    {
+        flat_set<int> fset;
+        fset.insert_range(std::vector{9, 3, 3, 7});
+        CHECK(std::ranges::equal(fset, std::vector{3, 7, 9}));
+
+        fset.insert_range(std::vector{10, 12, 9});              // after the old items - one equal at the boundary
+        fset.insert_range(std::list{8, 1, 3, 5});               // overlapping
+        fset.insert_range(std::views::iota(20, 23));
+        fset.insert_range(std::vector<int>{});
+
+        CHECK(std::ranges::equal(fset, std::vector{1, 3, 5, 7, 8, 9, 10, 12, 20, 21, 22}));
+        CHECK(fset.contains(12));
+        CHECK(!fset.contains(11));
+        CHECK(*fset.lower_bound(11) == 12);
+        CHECK(fset.erase(12) == 1);
+        CHECK(fset.erase(12) == 0);
+    }
+
+    SECTION("the same contents as std::set")
+    {
+        const std::vector<int> data = Helpers::create_numeric_dataset(100'000, -1000, 1000, Helpers::DatasetOptions{});
+
+        std::set<int> expected;
+        flat_set<int> one_by_one;
+        flat_set<int, std::greater<>> bulk;
+        for (size_t i = 0; i < data.size(); i += 1000)
+        {
+            const std::span chunk{data.begin() + i, 1000};
+            expected.insert(chunk.begin(), chunk.end());
+            for (int item : chunk)
+                append(one_by_one, item);
+            bulk.insert_range(chunk);
+        }
+
+        CHECK(std::ranges::equal(one_by_one, expected));
+        CHECK(std::ranges::equal(bulk, expected | std::views::reverse));
+    }
+
+    SECTION("flat_map - the first value of a key wins, like std::map")
+    {
+        flat_map<std::string, int> fmap = {{"two", 2}, {"one", 1}, {"two", 22}};
+
+        fmap.insert({"one", 11});
+        fmap.insert_range(std::vector<std::pair<std::string, int>>{{"three", 3}, {"one", 111}, {"three", 33}});
+        fmap["four"] = 4;
+        ++fmap["one"];
+
+        CHECK(fmap.size() == 4);
+        CHECK(fmap.at("one") == 2);
+        CHECK(fmap.at("two") == 2);
+        CHECK(fmap.at("three") == 3);
+        CHECK(fmap.begin()->first == "four");
+        CHECK_THROWS_AS(fmap.at("five"), std::out_of_range);
+    }
+}
+
+TEST_CASE("flat_set vs. std::set<int> - insert & lookup", "[.][benchmark]")
+{
+    auto measure = [](std::string_view name, size_t size, auto action) {
+        const auto start = std::chrono::steady_clock::now();
+        const size_t checksum = action();
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::cout << std::setw(10) << size << " ints - " << std::setw(36) << std::left << name << std::right << ": " << std::setw(10)
+                  << std::fixed << std::setprecision(2) << elapsed.count() << " ms (" << checksum << ")\n" << std::defaultfloat;
+    };
+
+    for (size_t size : {10'000ul, 1'000'000ul, 10'000'000ul})
+    {
+        const std::vector<int> data = Helpers::create_numeric_dataset(size, 0, std::numeric_limits<int>::max(), Helpers::DatasetOptions{});
+        const std::vector<int> keys = Helpers::create_numeric_dataset(size, 0, std::numeric_limits<int>::max(), Helpers::DatasetOptions{.seed = 7});
+
+        std::set<int> set;
+        Containers::flat_set<int> fset;
+
+        measure("std::set - append() one by one", size, [&] {
+            for (int item : data)
+                append(set, item);
+            return set.size();
+        });
+
+        if (size <= 100'000) // O(n^2) in total
+        {
+            measure("flat_set - append() one by one", size, [&] {
+                Containers::flat_set<int> fset;
+                for (int item : data)
+                    append(fset, item);
+                return fset.size();
+            });
+        }
+
+        measure("flat_set - insert_range", size, [&] {
+            fset.insert_range(data);
+            return fset.size();
+        });
+
+        measure("flat_set - insert_range of 10 chunks", size, [&] {
+            Containers::flat_set<int> fset;
+            for (size_t i = 0; i < 10; ++i)
+                fset.insert_range(std::span{data.begin() + size * i / 10, data.begin() + size * (i + 1) / 10});
+            return fset.size();
+        });
+
+        measure("std::set - lookups", size, [&] { return static_cast<size_t>(std::ranges::count_if(keys, [&](int key) { return set.contains(key); })); });
+        measure("flat_set - lookups", size, [&] { return static_cast<size_t>(std::ranges::count_if(keys, [&](int key) { return fset.contains(key); })); });
+    }
+}
+
 ///////////////////////////////////////////////////////////////
 // Lambdas in C++20
 
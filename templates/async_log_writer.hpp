@@ -0,0 +1,318 @@
+#ifndef ASYNC_LOG_WRITER_HPP
+#define ASYNC_LOG_WRITER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace Logging
+{
+    ///////////////////////////////////////////////////////////////////////
+    // Asynchronous, batched log writer
+    //  - every producing thread gets its own single-producer/single-consumer byte ring,
+    //    so the hot path is a memcpy and one release store - no locks, no allocations
+    //  - the ring holds records: [format function | payload size | payload]; the payload may be
+    //    ready text or binary arguments turned into text by the format function on the drain thread
+    //  - a background std::jthread drains all rings into one batch and writes it
+    //    with a single fwrite + fflush (one write syscall per flush)
+    //  - lines are published whole: a reader never sees half of a line
+    //  - a full ring applies back-pressure (the producer yields) - lines are never dropped
+    //  - a record too big for the ring is written by the producer itself, after its ring is written out
+    //  - the ring of an exited thread is released by the drain thread once it is empty
+
+    class AsyncLogWriter
+    {
+    public:
+        static constexpr size_t default_ring_capacity = 256 * 1024;
+
+        explicit AsyncLogWriter(std::FILE* out = stdout,
+            std::chrono::microseconds flush_interval = std::chrono::milliseconds{1},
+            size_t ring_capacity = default_ring_capacity)
+            : out_{out}
+            , flush_interval_{flush_interval}
+            , ring_capacity_{ring_capacity}
+            , drain_thread_{[this](std::stop_token stop_token) { drain_loop(stop_token); }}
+        {
+        }
+
+        AsyncLogWriter(const AsyncLogWriter&) = delete;
+        AsyncLogWriter& operator=(const AsyncLogWriter&) = delete;
+
+        ~AsyncLogWriter()
+        {
+            drain_thread_.request_stop();
+            drain_thread_.join(); // drain_loop flushes everything that was logged before
+        }
+
+        // formats a record's payload (on the drain thread) by appending text to out
+        using FormatFn = void (*)(const char* payload, size_t size, std::string& out);
+
+        // writes: parts... + '\n' as one line
+        template <typename... TParts>
+        void write_line(const TParts&... parts)
+        {
+            const std::string_view views[] = {std::string_view{parts}...};
+            size_t size = 1;
+            for (auto view : views)
+                size += view.size();
+
+            write_record(&append_text, size, [&](char* dest) {
+                for (auto view : views)
+                    dest = std::copy(view.begin(), view.end(), dest);
+                *dest = '\n';
+            });
+        }
+
+        // copies a payload of given size into the calling thread's ring - encode(char* dest) fills it;
+        // text is produced later by format(payload, size, out) called on the drain thread
+        template <typename TEncode>
+        void write_record(FormatFn format, size_t size, TEncode&& encode)
+        {
+            Ring& ring = this_thread_ring();
+
+            if (header_size + size > ring.capacity / 2) // might never fit - format & write on the calling thread
+            {
+                std::string payload(size, '\0');
+                encode(payload.data());
+                std::string text;
+                format(payload.data(), size, text);
+
+                // earlier lines of this thread go first - the drain thread moves the tail after writing them out
+                const size_t head = ring.head.load(std::memory_order_relaxed);
+                back_off_until([&] { return ring.tail.load(std::memory_order_acquire) == head; });
+
+                std::lock_guard lk{out_mtx_};
+                std::fwrite(text.data(), 1, text.size(), out_);
+                std::fflush(out_);
+                return;
+            }
+
+            // records never wrap around - the tail of the ring is skipped instead
+            size_t pos = ring.head.load(std::memory_order_relaxed);
+            const size_t contiguous = ring.capacity - pos % ring.capacity;
+            const size_t padding = (header_size + size > contiguous) ? contiguous : 0;
+
+            back_off_until([&] { return ring.capacity - (pos - ring.tail.load(std::memory_order_acquire)) >= padding + header_size + size; });
+
+            if (padding >= header_size)
+                ring.write_header(pos, &skip, padding - header_size);
+            pos += padding;
+
+            ring.write_header(pos, format, size);
+            encode(ring.at(pos + header_size));
+
+            ring.head.store(pos + header_size + size, std::memory_order_release);
+        }
+
+        // blocks until every line logged so far by any thread is written out
+        void flush()
+        {
+            const uint64_t requested = flush_requests_.fetch_add(1) + 1;
+            std::unique_lock lk{flush_mtx_};
+            flush_cv_.wait(lk, [&] { return flushes_done_ >= requested; });
+        }
+
+        // number of rings currently drained - the ring of an exited thread is released once it is empty
+        size_t no_of_rings()
+        {
+            std::lock_guard lk{rings_mtx_};
+            return rings_.size();
+        }
+
+    private:
+        struct Ring
+        {
+            const size_t capacity;
+            const std::unique_ptr<char[]> data;
+            alignas(64) std::atomic<size_t> head{0}; // written by the producer
+            alignas(64) std::atomic<size_t> tail{0}; // written by the drain thread
+
+            explicit Ring(size_t capacity)
+                : capacity{capacity}
+                , data{std::make_unique<char[]>(capacity)}
+            {
+            }
+
+            char* at(size_t pos) const noexcept
+            {
+                return data.get() + pos % capacity;
+            }
+
+            void write_header(size_t pos, FormatFn format, size_t size) noexcept
+            {
+                std::memcpy(at(pos), &format, sizeof(format));
+                std::memcpy(at(pos) + sizeof(format), &size, sizeof(size));
+            }
+
+            // formats all records in [from, to)
+            void format_records(size_t from, size_t to, std::string& batch) const
+            {
+                while (from != to)
+                {
+                    if (capacity - from % capacity < header_size) // too short for a header - skipped by the producer
+                    {
+                        from += capacity - from % capacity;
+                        continue;
+                    }
+
+                    FormatFn format;
+                    size_t size;
+                    std::memcpy(&format, at(from), sizeof(format));
+                    std::memcpy(&size, at(from) + sizeof(format), sizeof(size));
+
+                    format(at(from) + header_size, size, batch);
+                    from += header_size + size;
+                }
+            }
+        };
+
+        static constexpr size_t header_size = sizeof(FormatFn) + sizeof(size_t);
+
+        static void append_text(const char* payload, size_t size, std::string& out)
+        {
+            out.append(payload, size);
+        }
+
+        static void skip(const char*, size_t, std::string&)
+        {
+        }
+
+        static inline std::atomic<uint64_t> next_id_{0};
+
+        std::FILE* const out_;
+        const std::chrono::microseconds flush_interval_;
+        const size_t ring_capacity_;
+        const uint64_t id_ = next_id_.fetch_add(1);
+        std::mutex rings_mtx_;
+        std::vector<std::shared_ptr<Ring>> rings_;
+        std::mutex out_mtx_;
+        std::atomic<uint64_t> flush_requests_{0};
+        std::mutex flush_mtx_;
+        std::condition_variable flush_cv_;
+        uint64_t flushes_done_ = 0;
+        std::jthread drain_thread_; // last member - started after the rest is ready
+
+        template <typename TCondition>
+        void back_off_until(TCondition condition) const
+        {
+            for (int spins = 0; !condition(); ++spins)
+            {
+                if (spins < 16)
+                    std::this_thread::yield();
+                else
+                    std::this_thread::sleep_for(flush_interval_ / 4); // leave the cores to the drain thread
+            }
+        }
+
+        Ring& this_thread_ring()
+        {
+            // rings are looked up by writer id (not address) - a new writer may reuse the address of a destroyed one
+            struct Cache
+            {
+                uint64_t writer_id = UINT64_MAX;
+                std::shared_ptr<Ring> ring;
+            };
+            thread_local std::vector<Cache> cache;
+            thread_local Cache* last = nullptr;
+
+            if (last && last->writer_id == id_)
+                return *last->ring;
+
+            // rings of destroyed writers are owned only by the cache
+            std::erase_if(cache, [](const Cache& c) { return c.ring.use_count() == 1; });
+
+            auto it = std::find_if(cache.begin(), cache.end(), [this](const Cache& c) { return c.writer_id == id_; });
+            if (it == cache.end())
+            {
+                auto ring = std::make_shared<Ring>(ring_capacity_);
+                {
+                    std::lock_guard lk{rings_mtx_};
+                    rings_.push_back(ring);
+                }
+                cache.push_back(Cache{id_, std::move(ring)});
+                it = std::prev(cache.end());
+            }
+
+            last = &*it;
+            return *last->ring;
+        }
+
+        void drain_loop(std::stop_token stop_token)
+        {
+            std::string batch;
+            std::vector<std::shared_ptr<Ring>> rings;
+            std::vector<size_t> heads;
+
+            while (true)
+            {
+                const bool stopping = stop_token.stop_requested();
+                const uint64_t requested = flush_requests_.load();
+
+                {
+                    std::lock_guard lk{rings_mtx_};
+
+                    // a ring owned only by this list belongs to an exited thread - nothing more will be written to it
+                    std::erase_if(rings_, [](const std::shared_ptr<Ring>& ring) {
+                        if (ring.use_count() != 1)
+                            return false;
+                        std::atomic_thread_fence(std::memory_order_acquire); // pairs with the release of the thread's reference
+                        return ring->head.load(std::memory_order_acquire) == ring->tail.load(std::memory_order_relaxed);
+                    });
+
+                    rings.assign(rings_.begin(), rings_.end());
+                }
+
+                batch.clear();
+                heads.clear();
+                for (auto& ring : rings)
+                {
+                    const size_t tail = ring->tail.load(std::memory_order_relaxed);
+                    const size_t head = ring->head.load(std::memory_order_acquire);
+                    ring->format_records(tail, head, batch);
+                    heads.push_back(head);
+                }
+
+                if (!batch.empty())
+                {
+                    std::lock_guard lk{out_mtx_};
+                    std::fwrite(batch.data(), 1, batch.size(), out_);
+                    std::fflush(out_);
+                }
+
+                // the space is released after the write - an empty ring means its lines are already in out_
+                for (size_t i = 0; i < rings.size(); ++i)
+                    rings[i]->tail.store(heads[i], std::memory_order_release);
+                rings.clear();
+
+                if (requested > flushes_done_)
+                {
+                    {
+                        std::lock_guard lk{flush_mtx_};
+                        flushes_done_ = requested;
+                    }
+                    flush_cv_.notify_all();
+                }
+
+                if (stopping)
+                    return;
+
+                if (batch.empty() && flush_requests_.load() == requested)
+                    std::this_thread::sleep_for(flush_interval_);
+            }
+        }
+    };
+} // namespace Logging
+
+#endif // ASYNC_LOG_WRITER_HPP
@@ -1,8 +1,18 @@
+#include "async_log_writer.hpp"
+
 #include <catch2/catch_test_macros.hpp>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
-#include <vector>
-#include <string>
 #include <numbers>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <vector>
 
 using namespace std::literals;
 
@@ -72,6 +82,11 @@ struct Str
         std::copy(str, str + N, value);
     }
 
+    constexpr std::string_view view() const
+    {
+        return {value, N - 1};
+    }
+
     friend std::ostream& operator<<(std::ostream& out, const Str& str)
     {
         out << str.value;
@@ -80,15 +95,194 @@ struct Str
     }
 };
 
+//////////////////////////////////////////
+// compile-time format strings: "{}" is a placeholder, "{{" and "}}" are escaped braces
+
+struct FormatSpec
+{
+    size_t no_of_placeholders = 0;
+    bool is_valid = true;
+};
+
+constexpr FormatSpec parse_format(std::string_view fmt)
+{
+    FormatSpec spec;
+
+    for (size_t i = 0; i < fmt.size(); ++i)
+    {
+        const char next = (i + 1 < fmt.size()) ? fmt[i + 1] : '\0';
+
+        if (fmt[i] == '{' && next == '}')
+        {
+            ++spec.no_of_placeholders;
+            ++i;
+        }
+        else if ((fmt[i] == '{' || fmt[i] == '}') && next == fmt[i])
+            ++i;
+        else if (fmt[i] == '{' || fmt[i] == '}')
+            spec.is_valid = false;
+    }
+
+    return spec;
+}
+
+static_assert(parse_format("x = {}, y = {}").no_of_placeholders == 2);
+static_assert(parse_format("{{}} {}").no_of_placeholders == 1);
+static_assert(!parse_format("{0}").is_valid);
+
+namespace BinaryArgs
+{
+    template <typename T>
+    concept Loggable = std::is_arithmetic_v<T> || std::is_convertible_v<const T&, std::string_view>;
+
+    // type stored in the log record: numbers as they are, text as [size | chars]
+    template <typename T>
+    using Encoded = std::conditional_t<std::is_arithmetic_v<T>, T, std::string_view>;
+
+    template <typename T>
+    size_t encoded_size(const T& arg)
+    {
+        if constexpr (std::is_arithmetic_v<T>)
+            return sizeof(T);
+        else
+            return sizeof(size_t) + std::string_view{arg}.size();
+    }
+
+    template <typename T>
+    char* encode(char* dest, const T& arg)
+    {
+        if constexpr (std::is_arithmetic_v<T>)
+        {
+            std::memcpy(dest, &arg, sizeof(T));
+            return dest + sizeof(T);
+        }
+        else
+        {
+            const std::string_view text{arg};
+            const size_t size = text.size();
+            std::memcpy(dest, &size, sizeof(size));
+            std::memcpy(dest + sizeof(size), text.data(), size);
+            return dest + sizeof(size) + size;
+        }
+    }
+
+    template <typename T>
+    T decode(const char*& src)
+    {
+        if constexpr (std::is_arithmetic_v<T>)
+        {
+            T value;
+            std::memcpy(&value, src, sizeof(T));
+            src += sizeof(T);
+            return value;
+        }
+        else
+        {
+            size_t size;
+            std::memcpy(&size, src, sizeof(size));
+            src += sizeof(size);
+            return std::string_view{std::exchange(src, src + size), size};
+        }
+    }
+
+    template <typename T>
+    void append_value(std::string& out, const T& value)
+    {
+        if constexpr (std::is_same_v<T, bool>)
+            out.append(value ? "true" : "false");
+        else if constexpr (std::is_same_v<T, char>)
+            out.push_back(value);
+        else if constexpr (std::is_arithmetic_v<T>)
+        {
+            char buffer[64];
+            auto [end, ec] = std::to_chars(std::begin(buffer), std::end(buffer), value);
+            out.append(buffer, end);
+        }
+        else
+            out.append(value);
+    }
+
+    // turns a binary record into text - instantiated per (prefix, format, argument types)
+    template <Str Prefix, Str Fmt, typename... TEncoded>
+    void format_record([[maybe_unused]] const char* payload, size_t, std::string& out)
+    {
+        static constexpr std::string_view fmt = Fmt.view();
+
+        size_t pos = 0;
+        auto append_literal = [&] { // up to & including the next placeholder
+            while (pos < fmt.size())
+            {
+                if (pos + 1 < fmt.size() && fmt[pos] == '{' && fmt[pos + 1] == '}')
+                {
+                    pos += 2;
+                    return;
+                }
+                out.push_back(fmt[pos]);
+                pos += (fmt[pos] == '{' || fmt[pos] == '}') ? 2 : 1;
+            }
+        };
+
+        const std::tuple<TEncoded...> values{decode<TEncoded>(payload)...}; // braced init - decoded left to right
+
+        out.append(Prefix.view());
+        std::apply([&](const auto&... value) { ((append_literal(), append_value(out, value)), ...); }, values);
+        append_literal();
+        out.push_back('\n');
+    }
+} // namespace BinaryArgs
+
+// synchronous by default; constructed with an AsyncLogWriter it only copies
+// the line into the calling thread's ring buffer - the prefix is a compile-time constant either way
+//  - log<"fmt {}">(args...) checks the arguments at compile time & stores them in binary form,
+//    formatting is deferred to the drain thread
 template <Str Prefix>
 class Logger
 {
+    Logging::AsyncLogWriter* writer_ = nullptr;
+
 public:
-    void log(const std::string& msg)
+    Logger() = default;
+
+    explicit Logger(Logging::AsyncLogWriter& writer)
+        : writer_{&writer}
     {
-        std::cout << Prefix << msg << "\n";
     }
-};  
+
+    void log(std::string_view msg)
+    {
+        static constexpr std::string_view prefix = Prefix.view();
+
+        if (writer_)
+            writer_->write_line(prefix, msg);
+        else
+            std::cout << prefix << msg << "\n";
+    }
+
+    template <Str Fmt, typename... TArgs>
+    void log(const TArgs&... args)
+    {
+        static constexpr FormatSpec spec = parse_format(Fmt.view());
+        static_assert(spec.is_valid, "invalid format string - use {} for arguments, {{ and }} for braces");
+        static_assert(spec.no_of_placeholders == sizeof...(TArgs), "number of arguments doesn't match the format string");
+        static_assert((BinaryArgs::Loggable<TArgs> && ...), "only arithmetic & string-like arguments can be logged");
+
+        constexpr auto format = &BinaryArgs::format_record<Prefix, Fmt, BinaryArgs::Encoded<TArgs>...>;
+        const size_t size = (size_t{0} + ... + BinaryArgs::encoded_size(args));
+        auto encode = [&]([[maybe_unused]] char* dest) { ((dest = BinaryArgs::encode(dest, args)), ...); };
+
+        if (writer_)
+            writer_->write_record(format, size, encode);
+        else
+        {
+            thread_local std::string payload, text;
+            payload.resize(size);
+            encode(payload.data());
+            text.clear();
+            format(payload.data(), size, text);
+            std::cout << text;
+        }
+    }
+};
 
 TEST_CASE("Str as NTTP")
 {
@@ -101,6 +295,291 @@ TEST_CASE("Str as NTTP")
     logger2.log("Stop");
 }
 
+namespace
+{
+    std::vector<std::string> read_lines(std::FILE* file)
+    {
+        std::rewind(file);
+
+        std::vector<std::string> lines;
+        std::string line;
+        for (int c; (c = std::fgetc(file)) != EOF;)
+        {
+            if (c == '\n')
+                lines.push_back(std::exchange(line, {}));
+            else
+                line += static_cast<char>(c);
+        }
+
+        return lines;
+    }
+
+    // unbuffered streambuf on top of a FILE* - thread-safe like std::cout synchronized with stdio
+    class StdioBuffer : public std::streambuf
+    {
+        std::FILE* file_;
+
+    public:
+        explicit StdioBuffer(std::FILE* file)
+            : file_{file}
+        {
+        }
+
+    protected:
+        int_type overflow(int_type c) override
+        {
+            return traits_type::eq_int_type(c, traits_type::eof()) ? traits_type::not_eof(c) : std::fputc(c, file_);
+        }
+
+        std::streamsize xsputn(const char* s, std::streamsize n) override
+        {
+            return static_cast<std::streamsize>(std::fwrite(s, 1, static_cast<size_t>(n), file_));
+        }
+    };
+} // namespace
+
+TEST_CASE("Logger - async mode")
+{
+    std::FILE* out = std::tmpfile();
+    REQUIRE(out != nullptr);
+
+    SECTION("lines are written on flush")
+    {
+        Logging::AsyncLogWriter writer{out};
+        Logger<">: "> logger{writer};
+
+        logger.log("Start");
+        logger.log("Stop");
+        writer.flush();
+
+        CHECK(read_lines(out) == std::vector<std::string>{">: Start", ">: Stop"});
+    }
+
+    SECTION("lines from many threads are never torn")
+    {
+        constexpr int no_of_threads = 8;
+        constexpr int no_of_lines = 10'000;
+
+        {
+            // small rings - producers hit back-pressure & wrap-around
+            Logging::AsyncLogWriter writer{out, std::chrono::microseconds{100}, 512};
+
+            std::vector<std::jthread> threads;
+            for (int t = 0; t < no_of_threads; ++t)
+                threads.emplace_back([&writer, t] {
+                    Logger<"[worker]: "> logger{writer};
+                    const std::string msg = "thread#" + std::to_string(t) + " " + std::string(t * 10, '*');
+                    for (int i = 0; i < no_of_lines; ++i)
+                        logger.log(msg);
+                });
+        } // threads joined, then the writer drains the rest
+
+        std::vector<int> counters(no_of_threads);
+        for (const auto& line : read_lines(out))
+        {
+            const int t = line.at(std::string_view{"[worker]: thread#"}.size()) - '0';
+            REQUIRE(line == "[worker]: thread#" + std::to_string(t) + " " + std::string(t * 10, '*'));
+            ++counters[t];
+        }
+
+        CHECK(counters == std::vector<int>(no_of_threads, no_of_lines));
+    }
+
+    SECTION("lines too big for the ring keep their order")
+    {
+        constexpr int no_of_rounds = 100;
+        const std::string huge(1000, '#');
+
+        {
+            Logging::AsyncLogWriter writer{out, std::chrono::microseconds{100}, 512};
+            Logger<">: "> logger{writer};
+
+            for (int i = 0; i < no_of_rounds; ++i)
+            {
+                logger.log("before#" + std::to_string(i));
+                logger.log(huge);
+                logger.log("after#" + std::to_string(i));
+            }
+        }
+
+        std::vector<std::string> expected;
+        for (int i = 0; i < no_of_rounds; ++i)
+        {
+            expected.push_back(">: before#" + std::to_string(i));
+            expected.push_back(">: " + huge);
+            expected.push_back(">: after#" + std::to_string(i));
+        }
+
+        CHECK(read_lines(out) == expected);
+    }
+
+    SECTION("rings of exited threads are released")
+    {
+        constexpr int no_of_threads = 1000;
+        constexpr int threads_at_once = 8;
+
+        {
+            Logging::AsyncLogWriter writer{out, std::chrono::microseconds{100}, 4096};
+
+            for (int t = 0; t < no_of_threads; t += threads_at_once)
+            {
+                std::vector<std::jthread> threads;
+                for (int i = t; i < t + threads_at_once; ++i)
+                    threads.emplace_back([&writer, i] {
+                        Logger<"[short-lived]: "> logger{writer};
+                        logger.log("thread#" + std::to_string(i));
+                    });
+            }
+
+            // 1st flush writes out the rings, the drain loop after the 2nd one drops them
+            writer.flush();
+            writer.flush();
+            CHECK(writer.no_of_rings() == 0);
+        }
+
+        CHECK(read_lines(out).size() == no_of_threads);
+    }
+
+    std::fclose(out);
+}
+
+TEST_CASE("Logger - compile-time format strings")
+{
+    std::FILE* out = std::tmpfile();
+    REQUIRE(out != nullptr);
+
+    {
+        Logging::AsyncLogWriter writer{out};
+        Logger<">: "> logger{writer};
+
+        const std::string name = "pi";
+        logger.log<"{} = {}">(name, 3.14);
+        logger.log<"x = {}, y = {}, z = {}">(1, -2L, 3u);
+        logger.log<"{} {} {}">('c', true, "text");
+        logger.log<"{{}} {{{}}}">(42);
+        logger.log<"no args">();
+        logger.log<"{}%">(99);
+
+        // logger.log<"x = {}, y = {}">(1); // error: number of arguments doesn't match the format string
+        // logger.log<"{}">(std::vector{1, 2}); // error: only arithmetic & string-like arguments can be logged
+    }
+
+    CHECK(read_lines(out) == std::vector<std::string>{
+              ">: pi = 3.14", ">: x = 1, y = -2, z = 3", ">: c true text", ">: {} {42}", ">: no args", ">: 99%"});
+
+    std::fclose(out);
+
+    Logger<">>: "> sync_logger;
+    sync_logger.log<"sync: {} + {} = {}">(2, 2, 4);
+}
+
+TEST_CASE("Logger - sync vs. async - 8 threads", "[.][benchmark]")
+{
+    constexpr int no_of_threads = 8;
+    constexpr int lines_per_thread = 200'000;
+    constexpr std::string_view msg = "The quick brown fox jumps over the lazy dog";
+
+    auto run = [&](auto make_logger) {
+        std::vector<std::jthread> threads;
+        for (int t = 0; t < no_of_threads; ++t)
+            threads.emplace_back([&] {
+                auto logger = make_logger();
+                for (int i = 0; i < lines_per_thread; ++i)
+                    logger.log(msg);
+            });
+    };
+
+    auto report = [&](std::string_view name, auto elapsed) {
+        const double seconds = std::chrono::duration<double>(elapsed).count();
+        std::cout << name << ": " << static_cast<long long>(no_of_threads * lines_per_thread / seconds) << " lines/s\n";
+    };
+
+    {
+        std::FILE* sink = std::fopen("/dev/null", "w");
+        REQUIRE(sink != nullptr);
+        StdioBuffer sink_buffer{sink};
+        auto* cout_buffer = std::cout.rdbuf(&sink_buffer);
+
+        const auto start = std::chrono::steady_clock::now();
+        run([] { return Logger<">: ">{}; });
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        std::cout.rdbuf(cout_buffer);
+        std::fclose(sink);
+        report("sync (std::cout)", elapsed);
+    }
+
+    {
+        std::FILE* sink = std::fopen("/dev/null", "w");
+        REQUIRE(sink != nullptr);
+
+        const auto start = std::chrono::steady_clock::now();
+        {
+            Logging::AsyncLogWriter writer{sink};
+            run([&] { return Logger<">: ">{writer}; });
+        } // includes draining the rings
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        std::fclose(sink);
+        report("async (ring buffers + batched write)", elapsed);
+    }
+}
+
+TEST_CASE("Logger - ns per call - log<fmt> vs. std::cout <<", "[.][benchmark]")
+{
+    constexpr int no_of_rounds = 100;
+    constexpr int calls_per_round = 10'000; // a round fits in the ring - the producer never waits for the drain thread
+    const std::string name = "sensor";
+
+    auto report = [&](std::string_view title, std::chrono::nanoseconds elapsed) {
+        std::cout << title << ": " << static_cast<double>(elapsed.count()) / (no_of_rounds * calls_per_round) << " ns/call\n";
+    };
+
+    {
+        std::FILE* sink = std::fopen("/dev/null", "w");
+        REQUIRE(sink != nullptr);
+        StdioBuffer sink_buffer{sink};
+        auto* cout_buffer = std::cout.rdbuf(&sink_buffer);
+
+        std::chrono::nanoseconds elapsed{};
+        for (int round = 0; round < no_of_rounds; ++round)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < calls_per_round; ++i)
+                std::cout << ">: " << name << "#" << i << " = " << i * 0.5 << "\n";
+            elapsed += std::chrono::steady_clock::now() - start;
+        }
+
+        std::cout.rdbuf(cout_buffer);
+        std::fclose(sink);
+        report("std::cout <<", elapsed);
+    }
+
+    {
+        std::FILE* sink = std::fopen("/dev/null", "w");
+        REQUIRE(sink != nullptr);
+
+        std::chrono::nanoseconds elapsed{};
+        {
+            Logging::AsyncLogWriter writer{sink, std::chrono::milliseconds{1}, 1024 * 1024};
+            Logger<">: "> logger{writer};
+
+            for (int round = 0; round < no_of_rounds; ++round)
+            {
+                const auto start = std::chrono::steady_clock::now();
+                for (int i = 0; i < calls_per_round; ++i)
+                    logger.log<"{}#{} = {}">(name, i, i * 0.5);
+                elapsed += std::chrono::steady_clock::now() - start;
+
+                writer.flush();
+            }
+        }
+
+        std::fclose(sink);
+        report("log<\"{}#{} = {}\"> (async)", elapsed);
+    }
+}
+
 ///////////////////////////////////////////////////////////////
 // Lambda as NTTP
 
@@ -116,4 +595,4 @@ TEST_CASE("Lambda as NTTP")
 
     auto vat_ger = [] { return 0.19; };
     CHECK(calc_gross_price<vat_ger>(100.0) == 119.0);
-}
\ No newline at end of file
+}